@@ -0,0 +1,17 @@
+#.rst:
+# Findzstd
+# --------
+#
+# Try to find the zstd compression library
+
+find_path(ZSTD_INCLUDE_DIR zstd.h PATH_SUFFIXES include)
+
+if (NOT ZSTD_LIBRARIES)
+	find_library(ZSTD_LIBRARY_RELEASE NAMES zstd PATH_SUFFIXES lib)
+	include(SelectLibraryConfigurations)
+	SELECT_LIBRARY_CONFIGURATIONS(ZSTD)
+endif ()
+
+include(FindPackageHandleStandardArgs)
+FIND_PACKAGE_HANDLE_STANDARD_ARGS(ZSTD
+	                          REQUIRED_VARS ZSTD_LIBRARIES ZSTD_INCLUDE_DIR)
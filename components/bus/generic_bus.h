@@ -0,0 +1,377 @@
+/*
+ *  This file is part of Rabbits
+ *  Copyright (C) 2017  Clement Deschamps and Luc Michel
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef _RABBITS_COMPONENTS_BUS_GENERIC_BUS_H
+#define _RABBITS_COMPONENTS_BUS_GENERIC_BUS_H
+
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <limits>
+#include <sstream>
+
+#include <tlm_utils/multi_passthrough_target_socket.h>
+#include <tlm_utils/multi_passthrough_initiator_socket.h>
+
+#include <rabbits/component/component.h>
+#include <rabbits/component/port/tlm_bus.h>
+#include <rabbits/datatypes/address_map.h>
+#include <rabbits/rabbits_exception.h>
+
+/**
+ * @brief Generic memory mapped TLM bus.
+ *
+ * @tparam BUSWIDTH Width of the bus.
+ *
+ * Transactions are routed to the target mapped at their address, with the
+ * address made local to the target. Address decoding uses an AddressMap,
+ * so it does not depend on the number of mapped targets. DMI requests are
+ * forwarded and the granted ranges translated back to the bus address space,
+ * as are the ranges without DMI returned along with a denial. Mapping an empty
+ * range or one overlapping an already mapped range is a fatal error.
+ * DMI invalidations coming from a target are broadcast to all the initiators.
+ *
+ * Non-blocking transactions are forwarded phase by phase. The bus keeps track
+ * of the initiator and target of each of them until their completion, and
+ * gives back their original address to the initiator along with the response.
+ *
+ * The address map is exposed through the MemoryMappingInspectorScIface
+ * lookup API, so that tools can resolve addresses to targets with the same
+ * indexed structure as the bus itself.
+ */
+template <unsigned int BUSWIDTH = 32>
+class GenericBus : public Component, public TlmBusIface<BUSWIDTH> {
+public:
+    typedef typename TlmSocketBase<BUSWIDTH>::Target Target;
+    typedef typename TlmSocketBase<BUSWIDTH>::Initiator Initiator;
+
+protected:
+    typedef AddressMap<int>::Entry Mapping;
+
+    /* Initiators are bound to the target socket, targets to the initiator socket */
+    tlm_utils::multi_passthrough_target_socket<GenericBus, BUSWIDTH,
+        tlm::tlm_base_protocol_types, 0, sc_core::SC_ZERO_OR_MORE_BOUND> m_target_socket;
+    tlm_utils::multi_passthrough_initiator_socket<GenericBus, BUSWIDTH,
+        tlm::tlm_base_protocol_types, 0, sc_core::SC_ZERO_OR_MORE_BOUND> m_initiator_socket;
+
+    AddressMap<int> m_map;
+    std::vector<AddressRange> m_mapping;
+    std::vector<MemoryMapping> m_sorted_mapping;
+
+    std::map<Target*, int> m_target_ids;
+    std::vector< std::vector<AddressRange> > m_target_ranges;
+    std::vector<sc_core::sc_object*> m_target_objects;
+
+    static bool mapped_before(const MemoryMapping &m, const AddressRange &r)
+    {
+        return m.range.begin() < r.begin();
+    }
+
+    bool m_report_non_mapped;
+
+    /* Route of a non-blocking transaction in progress */
+    struct NbRoute {
+        int initiator;
+        int target;
+        uint64_t addr;
+    };
+
+    std::map<tlm::tlm_generic_payload*, NbRoute> m_nb_routes;
+
+    const Mapping * decode(uint64_t addr, unsigned int len) const
+    {
+        const Mapping *m = m_map.lookup(addr);
+
+        if ((m == nullptr) || (len && (len - 1 > m->range.end() - addr))) {
+            return nullptr;
+        }
+
+        return m;
+    }
+
+    void non_mapped_access(tlm::tlm_generic_payload &trans)
+    {
+        if (m_report_non_mapped) {
+            MLOG_F(SIM, ERR, "Non-mapped %s access at 0x%.8" PRIx64 ", length: %u byte(s)\n",
+                   trans.is_write() ? "write" : "read",
+                   static_cast<uint64_t>(trans.get_address()),
+                   trans.get_data_length());
+        }
+
+        trans.set_response_status(tlm::TLM_ADDRESS_ERROR_RESPONSE);
+    }
+
+    void b_transport(int id, tlm::tlm_generic_payload &trans, sc_core::sc_time &delay)
+    {
+        const uint64_t addr = trans.get_address();
+        const Mapping *m = decode(addr, trans.get_data_length());
+
+        if (m == nullptr) {
+            non_mapped_access(trans);
+            return;
+        }
+
+        trans.set_address(addr - m->range.begin());
+        m_initiator_socket[m->value]->b_transport(trans, delay);
+        trans.set_address(addr);
+    }
+
+    tlm::tlm_sync_enum nb_transport_fw(int id, tlm::tlm_generic_payload &trans,
+                                       tlm::tlm_phase &phase, sc_core::sc_time &t)
+    {
+        typename std::map<tlm::tlm_generic_payload*, NbRoute>::iterator it;
+        NbRoute route;
+        tlm::tlm_sync_enum ret;
+
+        it = m_nb_routes.find(&trans);
+
+        if (it != m_nb_routes.end()) {
+            route = it->second;
+        } else {
+            const uint64_t addr = trans.get_address();
+            const Mapping *m = decode(addr, trans.get_data_length());
+
+            if (m == nullptr) {
+                non_mapped_access(trans);
+                return tlm::TLM_COMPLETED;
+            }
+
+            route.initiator = id;
+            route.target = m->value;
+            route.addr = addr;
+
+            m_nb_routes[&trans] = route;
+            trans.set_address(addr - m->range.begin());
+        }
+
+        ret = m_initiator_socket[route.target]->nb_transport_fw(trans, phase, t);
+
+        if (ret == tlm::TLM_COMPLETED) {
+            trans.set_address(route.addr);
+            m_nb_routes.erase(&trans);
+        } else if ((ret == tlm::TLM_UPDATED) && (phase == tlm::BEGIN_RESP)) {
+            trans.set_address(route.addr);
+        }
+
+        return ret;
+    }
+
+    tlm::tlm_sync_enum nb_transport_bw(int id, tlm::tlm_generic_payload &trans,
+                                       tlm::tlm_phase &phase, sc_core::sc_time &t)
+    {
+        typename std::map<tlm::tlm_generic_payload*, NbRoute>::iterator it;
+        tlm::tlm_sync_enum ret;
+
+        it = m_nb_routes.find(&trans);
+
+        if (it == m_nb_routes.end()) {
+            MLOG(SIM, ERR) << "Backward path call for an unknown transaction\n";
+            return tlm::TLM_COMPLETED;
+        }
+
+        const NbRoute route = it->second;
+
+        if (phase == tlm::BEGIN_RESP) {
+            trans.set_address(route.addr);
+        }
+
+        ret = m_target_socket[route.initiator]->nb_transport_bw(trans, phase, t);
+
+        if ((ret == tlm::TLM_COMPLETED)
+            || ((ret == tlm::TLM_UPDATED) && (phase == tlm::END_RESP))) {
+            m_nb_routes.erase(&trans);
+        }
+
+        return ret;
+    }
+
+    unsigned int transport_dbg(int id, tlm::tlm_generic_payload &trans)
+    {
+        const uint64_t addr = trans.get_address();
+        const unsigned int len = trans.get_data_length();
+        const Mapping *m = m_map.lookup(addr);
+        unsigned int ret;
+
+        if (m == nullptr) {
+            return 0;
+        }
+
+        /* Debug accesses are truncated at the end of the target */
+        trans.set_address(addr - m->range.begin());
+        trans.set_data_length(std::min<uint64_t>(len, m->range.end() - addr + 1));
+
+        ret = m_initiator_socket[m->value]->transport_dbg(trans);
+
+        trans.set_address(addr);
+        trans.set_data_length(len);
+
+        return ret;
+    }
+
+    bool get_direct_mem_ptr(int id, tlm::tlm_generic_payload &trans, tlm::tlm_dmi &dmi)
+    {
+        const uint64_t addr = trans.get_address();
+        const Mapping *m = m_map.lookup(addr);
+        bool ret;
+
+        if (m == nullptr) {
+            /* No DMI in the whole hole around the address */
+            typename AddressMap<int>::const_iterator next = m_map.lower_bound(addr);
+
+            dmi.set_start_address((next == m_map.begin()) ? 0 : (next - 1)->range.end() + 1);
+            dmi.set_end_address((next == m_map.end()) ? std::numeric_limits<uint64_t>::max()
+                                                       : next->range.begin() - 1);
+            return false;
+        }
+
+        trans.set_address(addr - m->range.begin());
+        ret = m_initiator_socket[m->value]->get_direct_mem_ptr(trans, dmi);
+        trans.set_address(addr);
+
+        const uint64_t end = std::min<uint64_t>(dmi.get_end_address(), m->range.size() - 1);
+
+        if (!ret) {
+            /*
+             * The target describes the region without DMI around the
+             * address, in its own address space. Keep the part of it lying
+             * in the mapping.
+             */
+            const uint64_t start = std::min<uint64_t>(dmi.get_start_address(),
+                                                      addr - m->range.begin());
+
+            dmi.set_start_address(m->range.begin() + start);
+            dmi.set_end_address(m->range.begin() + std::max(end, addr - m->range.begin()));
+
+            return false;
+        }
+
+        dmi.set_start_address(m->range.begin() + dmi.get_start_address());
+        dmi.set_end_address(m->range.begin() + end);
+
+        return true;
+    }
+
+    void invalidate_direct_mem_ptr(int id, sc_dt::uint64 start, sc_dt::uint64 end)
+    {
+        for (const AddressRange &r : m_target_ranges[id]) {
+            if (start >= r.size()) {
+                continue;
+            }
+
+            const uint64_t g_start = r.begin() + start;
+            const uint64_t g_end = r.begin() + std::min<uint64_t>(end, r.size() - 1);
+
+            for (unsigned int i = 0; i < m_target_socket.size(); i++) {
+                m_target_socket[i]->invalidate_direct_mem_ptr(g_start, g_end);
+            }
+        }
+    }
+
+public:
+    TlmBusPort<BUSWIDTH> p_bus;
+
+    GenericBus(sc_core::sc_module_name name, const Parameters &params, ConfigManager &c)
+        : Component(name, params, c)
+        , m_target_socket("target_socket")
+        , m_initiator_socket("initiator_socket")
+        , p_bus("bus", *this)
+    {
+        m_report_non_mapped =
+            c.get_global_params()["report-non-mapped-access"].template as<bool>();
+
+        m_target_socket.register_b_transport(this, &GenericBus::b_transport);
+        m_target_socket.register_nb_transport_fw(this, &GenericBus::nb_transport_fw);
+        m_target_socket.register_transport_dbg(this, &GenericBus::transport_dbg);
+        m_target_socket.register_get_direct_mem_ptr(this, &GenericBus::get_direct_mem_ptr);
+        m_initiator_socket.register_nb_transport_bw(this, &GenericBus::nb_transport_bw);
+        m_initiator_socket.register_invalidate_direct_mem_ptr(this,
+                                                              &GenericBus::invalidate_direct_mem_ptr);
+    }
+
+    virtual ~GenericBus() {}
+
+    /* TlmBusIface */
+    void connect_target(Target &s, const AddressRange &r)
+    {
+        int id;
+        typename std::map<Target*, int>::iterator it = m_target_ids.find(&s);
+
+        id = (it == m_target_ids.end()) ? m_target_ranges.size() : it->second;
+
+        /* Reject the range before binding anything */
+        if (!m_map.insert(r, id)) {
+            std::stringstream ss;
+            ss << "Range " << r << " is empty or overlaps an already mapped range";
+            MLOG(APP, ERR) << ss.str() << "\n";
+            throw RabbitsException(ss.str());
+        }
+
+        if (it == m_target_ids.end()) {
+            m_initiator_socket.bind(s);
+            m_target_ids[&s] = id;
+            m_target_ranges.push_back(std::vector<AddressRange>());
+            m_target_objects.push_back(s.get_base_export().get_parent_object());
+        }
+
+        m_target_ranges[id].push_back(r);
+        m_mapping.push_back(r);
+
+        const MemoryMapping mapping = { r, m_target_objects[id] };
+        m_sorted_mapping.insert(std::lower_bound(m_sorted_mapping.begin(),
+                                                 m_sorted_mapping.end(),
+                                                 r, mapped_before),
+                                mapping);
+    }
+
+    void connect_initiator(Initiator &s)
+    {
+        m_target_socket.bind(s);
+    }
+
+    sc_core::sc_module * get_sc_module() { return this; }
+
+    /* MemoryMappingInspectorScIface */
+    const std::vector<AddressRange> & get_memory_mapping() const
+    {
+        return m_mapping;
+    }
+
+    bool lookup_target(uint64_t addr, MemoryMapping &mapping, uint64_t &offset) const
+    {
+        const Mapping *m = m_map.lookup(addr);
+
+        if (m == nullptr) {
+            return false;
+        }
+
+        mapping.range = m->range;
+        mapping.target = m_target_objects[m->value];
+        offset = addr - m->range.begin();
+
+        return true;
+    }
+
+    MemoryMappingView get_memory_mapping_view() const
+    {
+        const MemoryMapping *first = m_sorted_mapping.data();
+        return MemoryMappingView(first, first + m_sorted_mapping.size());
+    }
+};
+
+#endif
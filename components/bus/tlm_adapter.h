@@ -0,0 +1,377 @@
+/*
+ *  This file is part of Rabbits
+ *  Copyright (C) 2017  Clement Deschamps and Luc Michel
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef _RABBITS_COMPONENTS_BUS_TLM_ADAPTER_H
+#define _RABBITS_COMPONENTS_BUS_TLM_ADAPTER_H
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <vector>
+
+#include <rabbits/component/component.h>
+#include <rabbits/component/port/tlm_target.h>
+#include <rabbits/component/port/tlm_initiator.h>
+
+/**
+ * @brief Bus width and endianness adapter.
+ *
+ * @tparam IN_BUSWIDTH Width of the bus on the initiator side.
+ * @tparam OUT_BUSWIDTH Width of the bus on the target side.
+ * @tparam SWAP If true, byte swap the data crossing the adapter.
+ *
+ * Accesses wider than the target side bus are split into bus wide accesses.
+ * Narrower accesses fit on a wider bus and go through as is.
+ *
+ * When swapping is enabled, the adapter behaves as a word-invariant
+ * endianness bridge: the byte at offset k of a target side bus word is seen
+ * at offset (OUT_BUSWIDTH / 8 - 1 - k) by the initiators. Bus wide chunks are
+ * byte reversed, and accesses to a part of a bus word are reversed and moved
+ * to the mirrored address inside the word. The swapped data goes through a
+ * bounce buffer, the initiator data array is never modified on writes.
+ * Swapped blocking accesses with byte enables or a streaming width are
+ * rejected.
+ *
+ * DMI requests and invalidations pass through the adapter when the memory
+ * layout is the same on both sides, i.e. when no swap is done.
+ *
+ * Non-blocking transactions are forwarded phase by phase. They are never
+ * split, the target has to handle the access width. When swapping, they must
+ * fit in a bus word or be made of whole aligned bus words.
+ */
+template <unsigned int IN_BUSWIDTH, unsigned int OUT_BUSWIDTH, bool SWAP = false>
+class TlmAdapter : public Component,
+                   public tlm::tlm_fw_transport_if<>,
+                   public tlm::tlm_bw_transport_if<> {
+protected:
+    enum { OUT_BYTES = OUT_BUSWIDTH / 8 };
+
+    /* In-flight swapped non-blocking transaction */
+    struct NbBounce {
+        uint64_t addr;
+        uint8_t *data;
+        std::vector<uint8_t> buf;
+    };
+
+    /* Bounce buffers of the swapped accesses */
+    std::vector<uint8_t> m_bounce;
+    std::vector<uint8_t> m_dbg_bounce;
+    std::map<tlm::tlm_generic_payload*, NbBounce> m_nb_bounce;
+
+    static void swap(uint8_t *data, unsigned int len)
+    {
+        for (unsigned int i = 0; i < len; i += OUT_BYTES) {
+            uint8_t *chunk = data + i;
+            std::reverse(chunk, chunk + std::min<unsigned int>(OUT_BYTES, len - i));
+        }
+    }
+
+    /* True if the access fits in a bus word or is made of aligned bus words */
+    static bool swappable(uint64_t addr, unsigned int len)
+    {
+        const unsigned int off = addr % OUT_BYTES;
+
+        return (off + len <= OUT_BYTES) || ((off == 0) && (len % OUT_BYTES == 0));
+    }
+
+    /* Target side address of a swappable access */
+    static uint64_t swap_address(uint64_t addr, unsigned int len)
+    {
+        const unsigned int off = addr % OUT_BYTES;
+
+        if (len >= OUT_BYTES) {
+            return addr;
+        }
+
+        return addr - off + (OUT_BYTES - off - len);
+    }
+
+    /*
+     * Forward a swapped access through the bounce buffer, as a sequence of
+     * swappable pieces: the partial bus words at both ends, and the whole
+     * bus words in the middle. Return the number of bytes successfully
+     * accessed, forward() being called on each piece and returning the same.
+     */
+    template <class FORWARD>
+    unsigned int swap_transport(tlm::tlm_generic_payload &trans,
+                                std::vector<uint8_t> &bounce, FORWARD forward)
+    {
+        const uint64_t addr = trans.get_address();
+        uint8_t * const data = trans.get_data_ptr();
+        const unsigned int len = trans.get_data_length();
+        const unsigned int width = trans.get_streaming_width();
+        unsigned int done = 0;
+
+        if (trans.is_write()) {
+            bounce.assign(data, data + len);
+        } else {
+            bounce.resize(len);
+        }
+
+        while (done < len) {
+            const uint64_t cur = addr + done;
+            const unsigned int off = cur % OUT_BYTES;
+            uint8_t * const piece = bounce.data() + done;
+            unsigned int plen;
+
+            if (off || (len - done < OUT_BYTES)) {
+                plen = std::min<unsigned int>(OUT_BYTES - off, len - done);
+            } else {
+                plen = (len - done) - (len - done) % OUT_BYTES;
+            }
+
+            if (trans.is_write()) {
+                swap(piece, plen);
+            }
+
+            trans.set_address(swap_address(cur, plen));
+            trans.set_data_ptr(piece);
+            trans.set_data_length(plen);
+            trans.set_streaming_width(plen);
+
+            const unsigned int ret = forward(trans);
+
+            if (ret < plen) {
+                break;
+            }
+
+            if (trans.is_read()) {
+                swap(piece, plen);
+            }
+
+            done += plen;
+        }
+
+        if (trans.is_read()) {
+            std::memcpy(data, bounce.data(), done);
+        }
+
+        trans.set_address(addr);
+        trans.set_data_ptr(data);
+        trans.set_data_length(len);
+        trans.set_streaming_width(width);
+
+        return done;
+    }
+
+    void nb_swap_request(tlm::tlm_generic_payload &trans)
+    {
+        NbBounce &b = m_nb_bounce[&trans];
+        const unsigned int len = trans.get_data_length();
+
+        b.addr = trans.get_address();
+        b.data = trans.get_data_ptr();
+
+        if (trans.is_write()) {
+            b.buf.assign(b.data, b.data + len);
+            swap(b.buf.data(), len);
+        } else {
+            b.buf.resize(len);
+        }
+
+        trans.set_address(swap_address(b.addr, len));
+        trans.set_data_ptr(b.buf.data());
+    }
+
+    void nb_swap_response(tlm::tlm_generic_payload &trans)
+    {
+        typename std::map<tlm::tlm_generic_payload*, NbBounce>::iterator it;
+
+        it = m_nb_bounce.find(&trans);
+        if (it == m_nb_bounce.end()) {
+            return;
+        }
+
+        NbBounce &b = it->second;
+
+        if (trans.is_read()) {
+            swap(b.buf.data(), b.buf.size());
+            std::memcpy(b.data, b.buf.data(), b.buf.size());
+        }
+
+        trans.set_address(b.addr);
+        trans.set_data_ptr(b.data);
+        m_nb_bounce.erase(it);
+    }
+
+    static bool need_split(const tlm::tlm_generic_payload &trans)
+    {
+        const unsigned int len = trans.get_data_length();
+        const unsigned int width = trans.get_streaming_width();
+
+        return (len > OUT_BYTES)
+            && (trans.get_byte_enable_ptr() == nullptr)
+            && ((width == 0) || (width >= len));
+    }
+
+    void split_transport(tlm::tlm_generic_payload &trans, sc_core::sc_time &delay)
+    {
+        const uint64_t addr = trans.get_address();
+        uint8_t * const data = trans.get_data_ptr();
+        const unsigned int len = trans.get_data_length();
+
+        /* The payload is reused for each chunk and restored afterwards */
+        for (unsigned int i = 0; i < len; i += OUT_BYTES) {
+            const unsigned int chunk = std::min<unsigned int>(OUT_BYTES, len - i);
+
+            trans.set_address(addr + i);
+            trans.set_data_ptr(data + i);
+            trans.set_data_length(chunk);
+            trans.set_streaming_width(chunk);
+            trans.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
+
+            p_out.socket->b_transport(trans, delay);
+
+            if (trans.is_response_error()) {
+                break;
+            }
+        }
+
+        trans.set_address(addr);
+        trans.set_data_ptr(data);
+        trans.set_data_length(len);
+        trans.set_streaming_width(len);
+    }
+
+public:
+    TlmTargetPort<IN_BUSWIDTH> p_in;
+    TlmInitiatorPort<OUT_BUSWIDTH> p_out;
+
+    TlmAdapter(sc_core::sc_module_name name, const Parameters &params, ConfigManager &c)
+        : Component(name, params, c)
+        , p_in("in", *this)
+        , p_out("out", *this)
+    {}
+
+    TlmAdapter(sc_core::sc_module_name name, ConfigManager &c)
+        : Component(name, c)
+        , p_in("in", *this)
+        , p_out("out", *this)
+    {}
+
+    virtual ~TlmAdapter() {}
+
+    /* tlm::tlm_fw_transport_if */
+    void b_transport(tlm::tlm_generic_payload &trans, sc_core::sc_time &delay)
+    {
+        if (!SWAP) {
+            if (need_split(trans)) {
+                split_transport(trans, delay);
+            } else {
+                p_out.socket->b_transport(trans, delay);
+            }
+            return;
+        }
+
+        const unsigned int len = trans.get_data_length();
+        const unsigned int width = trans.get_streaming_width();
+
+        trans.set_dmi_allowed(false);
+
+        if (trans.get_byte_enable_ptr()) {
+            trans.set_response_status(tlm::TLM_BYTE_ENABLE_ERROR_RESPONSE);
+            return;
+        }
+
+        if (width && (width < len)) {
+            trans.set_response_status(tlm::TLM_BURST_ERROR_RESPONSE);
+            return;
+        }
+
+        swap_transport(trans, m_bounce,
+                       [this, &delay] (tlm::tlm_generic_payload &t) -> unsigned int {
+            t.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
+
+            if (need_split(t)) {
+                split_transport(t, delay);
+            } else {
+                p_out.socket->b_transport(t, delay);
+            }
+
+            return t.is_response_error() ? 0 : t.get_data_length();
+        });
+
+        trans.set_dmi_allowed(false);
+    }
+
+    tlm::tlm_sync_enum nb_transport_fw(tlm::tlm_generic_payload &trans,
+                                       tlm::tlm_phase &phase, sc_core::sc_time &t)
+    {
+        tlm::tlm_sync_enum ret;
+
+        if (SWAP && (phase == tlm::BEGIN_REQ)) {
+            if (!swappable(trans.get_address(), trans.get_data_length())) {
+                trans.set_response_status(tlm::TLM_ADDRESS_ERROR_RESPONSE);
+                return tlm::TLM_COMPLETED;
+            }
+
+            nb_swap_request(trans);
+        }
+
+        ret = p_out.socket->nb_transport_fw(trans, phase, t);
+
+        if (SWAP && ((ret == tlm::TLM_COMPLETED)
+                     || ((ret == tlm::TLM_UPDATED) && (phase == tlm::BEGIN_RESP)))) {
+            nb_swap_response(trans);
+        }
+
+        return ret;
+    }
+
+    bool get_direct_mem_ptr(tlm::tlm_generic_payload &trans, tlm::tlm_dmi &dmi)
+    {
+        if (SWAP) {
+            return false;
+        }
+
+        return p_out.socket->get_direct_mem_ptr(trans, dmi);
+    }
+
+    unsigned int transport_dbg(tlm::tlm_generic_payload &trans)
+    {
+        if (!SWAP) {
+            return p_out.socket->transport_dbg(trans);
+        }
+
+        return swap_transport(trans, m_dbg_bounce,
+                              [this] (tlm::tlm_generic_payload &t) -> unsigned int {
+            return p_out.socket->transport_dbg(t);
+        });
+    }
+
+    /* tlm::tlm_bw_transport_if */
+    tlm::tlm_sync_enum nb_transport_bw(tlm::tlm_generic_payload &trans,
+                                       tlm::tlm_phase &phase, sc_core::sc_time &t)
+    {
+        if (SWAP && (phase == tlm::BEGIN_RESP)) {
+            nb_swap_response(trans);
+        }
+
+        return p_in.socket->nb_transport_bw(trans, phase, t);
+    }
+
+    void invalidate_direct_mem_ptr(sc_dt::uint64 start, sc_dt::uint64 end)
+    {
+        if (!SWAP) {
+            p_in.socket->invalidate_direct_mem_ptr(start, end);
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,138 @@
+/*
+ *  This file is part of Rabbits
+ *  Copyright (C) 2017  Clement Deschamps and Luc Michel
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/**
+ * @file bus_access_queue.h
+ * @brief BusAccessQueue class declaration
+ */
+
+#ifndef _RABBITS_COMPONENT_BUS_ACCESS_QUEUE_H
+#define _RABBITS_COMPONENT_BUS_ACCESS_QUEUE_H
+
+#include <vector>
+#include <mutex>
+#include <future>
+#include <functional>
+
+#include <systemc>
+
+#include "rabbits/component/debug_initiator.h"
+
+/**
+ * @brief Queue of debug bus accesses posted by host threads.
+ *
+ * Debug accesses must be emitted from inside the SystemC kernel. This channel
+ * lets any host thread post them. Posting an access is thread safe and
+ * returns immediately. Pending accesses are drained by batch during the
+ * next update phase of the kernel, through the given DebugInitiator, and
+ * complete either through a future or a callback.
+ *
+ * Callbacks are called from the SystemC kernel thread. They must not block,
+ * nor call any SystemC wait function.
+ *
+ * Accesses are only drained while the simulation runs. If the simulation is
+ * paused or starving, they stay pending until it resumes.
+ */
+class BusAccessQueue : public sc_core::sc_prim_channel {
+public:
+    /**
+     * @brief Read completion callback, called with the data effectively read.
+     */
+    typedef std::function<void (const std::vector<uint8_t> &data)> ReadCallback;
+
+    /**
+     * @brief Write completion callback, called with the number of bytes
+     *        effectively written.
+     */
+    typedef std::function<void (uint64_t written)> WriteCallback;
+
+private:
+    struct Request {
+        tlm::tlm_command cmd;
+        uint64_t addr;
+        uint64_t size;
+        std::vector<uint8_t> data;
+        ReadCallback read_cb;
+        WriteCallback write_cb;
+    };
+
+    DebugInitiator &m_initiator;
+
+    std::mutex m_mutex;
+    std::vector<Request> m_pending;
+
+    /* Only touched by the kernel thread, keeps its capacity across drains */
+    std::vector<Request> m_draining;
+
+    void post(Request &r);
+    void process(Request &r);
+
+protected:
+    /* sc_core::sc_prim_channel */
+    void update();
+
+public:
+    explicit BusAccessQueue(DebugInitiator &initiator);
+    BusAccessQueue(const char *name, DebugInitiator &initiator);
+    virtual ~BusAccessQueue();
+
+    /**
+     * @brief Post a debug read access.
+     *
+     * @param[in] addr Address of the read access.
+     * @param[in] size Size of the read access.
+     * @param[in] cb Optional completion callback.
+     */
+    void post_read(uint64_t addr, uint64_t size, ReadCallback cb = ReadCallback());
+
+    /**
+     * @brief Post a debug write access.
+     *
+     * The data is copied, the buffer can be reused as soon as the method
+     * returns.
+     *
+     * @param[in] addr Address of the write access.
+     * @param[in] buf Data to write.
+     * @param[in] size Size of the write access.
+     * @param[in] cb Optional completion callback.
+     */
+    void post_write(uint64_t addr, const void *buf, uint64_t size,
+                    WriteCallback cb = WriteCallback());
+
+    /**
+     * @brief Post a debug read access completing through a future.
+     *
+     * @return a future holding the data effectively read.
+     */
+    std::future< std::vector<uint8_t> > read(uint64_t addr, uint64_t size);
+
+    /**
+     * @brief Post a debug write access completing through a future.
+     *
+     * @return a future holding the number of bytes effectively written.
+     */
+    std::future<uint64_t> write(uint64_t addr, const void *buf, uint64_t size);
+
+    /**
+     * @brief Return the number of accesses waiting to be drained.
+     */
+    size_t pending();
+};
+
+#endif
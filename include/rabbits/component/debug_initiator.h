@@ -36,8 +36,15 @@
  *
  * This helper component allows to easily emits read or write debug requests on
  * the bus it is connected to.
+ *
+ * Requests are served with a memory copy on the parts of the range where the
+ * targets grant DMI access, which makes loading large images into memory
+ * fast. The rest goes through debug transport, in chunks.
  */
 class DebugInitiator : public Master<> {
+private:
+    uint64_t debug_access(tlm::tlm_command cmd, uint64_t addr, uint8_t *buf, uint64_t size);
+
 public:
     DebugInitiator(sc_core::sc_module_name name, ConfigManager &config);
     DebugInitiator(sc_core::sc_module_name name, Parameters &cp, ConfigManager &config);
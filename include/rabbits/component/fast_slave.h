@@ -0,0 +1,203 @@
+/*
+ *  This file is part of Rabbits
+ *  Copyright (C) 2017  Clement Deschamps and Luc Michel
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/**
+ * @file fast_slave.h
+ * @brief FastSlave class declaration
+ */
+
+#ifndef _RABBITS_COMPONENT_FAST_SLAVE_H
+#define _RABBITS_COMPONENT_FAST_SLAVE_H
+
+#include <type_traits>
+
+#include "rabbits/component/slave.h"
+
+/* True if Derived kept the Slave implementation of the callback M */
+#define FAST_SLAVE_INHERITED(M) \
+    (std::is_same<decltype(&Derived::M), decltype(&Base::M)>::value)
+
+/**
+ * @brief Slave dispatching bus accesses to its callbacks statically.
+ *
+ * @tparam Derived The final slave class, deriving from FastSlave<Derived>.
+ * @tparam BUSWIDTH Width of the bus the slave will be connected to.
+ *
+ * Slave::b_transport() reaches the width specific callbacks through two
+ * virtual calls (bus_cb_read then bus_cb_read_32 for instance). FastSlave
+ * calls the callbacks of Derived with qualified calls instead, that the
+ * compiler can inline. The callback names and signatures are the ones of
+ * Slave, so a model switches by changing its base class only:
+ *
+ * @code
+ * class MyTimer : public FastSlave<MyTimer> {
+ * public:
+ *     void bus_cb_read_32(uint64_t addr, uint32_t *value, bool &bErr);
+ *     void bus_cb_write_32(uint64_t addr, uint32_t *value, bool &bErr);
+ * };
+ * @endcode
+ *
+ * When Derived overrides bus_cb_read, bus_cb_write or the block callbacks,
+ * they are called (statically as well) instead of the width dispatch.
+ * Classes deriving from Derived are still dispatched to the callbacks of
+ * Derived, so Derived is expected to be the most derived class.
+ *
+ * The callbacks are named from FastSlave, so Derived must make them public,
+ * or declare FastSlave as a friend when it keeps them private or protected:
+ *
+ * @code
+ * class MyTimer : public FastSlave<MyTimer> {
+ *     friend class FastSlave<MyTimer>;
+ *
+ * private:
+ *     void bus_cb_read_32(uint64_t addr, uint32_t *value, bool &bErr);
+ *     void bus_cb_write_32(uint64_t addr, uint32_t *value, bool &bErr);
+ * };
+ * @endcode
+ */
+template <class Derived, unsigned int BUSWIDTH = 32>
+class FastSlave : public Slave<BUSWIDTH> {
+private:
+    typedef Slave<BUSWIDTH> Base;
+
+    Derived & derived() { return *static_cast<Derived*>(this); }
+
+    template <bool INHERITED> struct Tag {};
+
+    void read_block(uint64_t addr, uint8_t *data, unsigned int len, bool &bErr, Tag<true>)
+    {
+        Base::split_access([this] (bool w, uint64_t a, uint8_t *d, unsigned int l, bool &e) {
+            access(w, a, d, l, e);
+        }, false, addr, data, len, bErr);
+    }
+
+    void read_block(uint64_t addr, uint8_t *data, unsigned int len, bool &bErr, Tag<false>)
+    {
+        derived().Derived::bus_cb_read_block(addr, data, len, bErr);
+    }
+
+    void write_block(uint64_t addr, uint8_t *data, unsigned int len, bool &bErr, Tag<true>)
+    {
+        Base::split_access([this] (bool w, uint64_t a, uint8_t *d, unsigned int l, bool &e) {
+            access(w, a, d, l, e);
+        }, true, addr, data, len, bErr);
+    }
+
+    void write_block(uint64_t addr, uint8_t *data, unsigned int len, bool &bErr, Tag<false>)
+    {
+        derived().Derived::bus_cb_write_block(addr, data, len, bErr);
+    }
+
+    void read(uint64_t addr, uint8_t *data, unsigned int len, bool &bErr, Tag<true>)
+    {
+        Derived &d = derived();
+
+        switch (len) {
+        case 1:
+            d.Derived::bus_cb_read_8(addr, data, bErr);
+            break;
+        case 2:
+            d.Derived::bus_cb_read_16(addr, reinterpret_cast<uint16_t*>(data), bErr);
+            break;
+        case 4:
+            d.Derived::bus_cb_read_32(addr, reinterpret_cast<uint32_t*>(data), bErr);
+            break;
+        case 8:
+            d.Derived::bus_cb_read_64(addr, reinterpret_cast<uint64_t*>(data), bErr);
+            break;
+        default:
+            read_block(addr, data, len, bErr, Tag<FAST_SLAVE_INHERITED(bus_cb_read_block)>());
+            break;
+        }
+    }
+
+    void read(uint64_t addr, uint8_t *data, unsigned int len, bool &bErr, Tag<false>)
+    {
+        derived().Derived::bus_cb_read(addr, data, len, bErr);
+    }
+
+    void write(uint64_t addr, uint8_t *data, unsigned int len, bool &bErr, Tag<true>)
+    {
+        Derived &d = derived();
+
+        switch (len) {
+        case 1:
+            d.Derived::bus_cb_write_8(addr, data, bErr);
+            break;
+        case 2:
+            d.Derived::bus_cb_write_16(addr, reinterpret_cast<uint16_t*>(data), bErr);
+            break;
+        case 4:
+            d.Derived::bus_cb_write_32(addr, reinterpret_cast<uint32_t*>(data), bErr);
+            break;
+        case 8:
+            d.Derived::bus_cb_write_64(addr, reinterpret_cast<uint64_t*>(data), bErr);
+            break;
+        default:
+            write_block(addr, data, len, bErr, Tag<FAST_SLAVE_INHERITED(bus_cb_write_block)>());
+            break;
+        }
+    }
+
+    void write(uint64_t addr, uint8_t *data, unsigned int len, bool &bErr, Tag<false>)
+    {
+        derived().Derived::bus_cb_write(addr, data, len, bErr);
+    }
+
+protected:
+    /**
+     * @brief Dispatch one access to the callbacks of Derived.
+     */
+    void access(bool is_write, uint64_t addr, uint8_t *data, unsigned int len, bool &bErr)
+    {
+        if (is_write) {
+            write(addr, data, len, bErr, Tag<FAST_SLAVE_INHERITED(bus_cb_write)>());
+        } else {
+            read(addr, data, len, bErr, Tag<FAST_SLAVE_INHERITED(bus_cb_read)>());
+        }
+    }
+
+public:
+    FastSlave(sc_core::sc_module_name name, ConfigManager &c)
+        : Base(name, c)
+    {}
+
+    FastSlave(sc_core::sc_module_name name, const Parameters &params, ConfigManager &c)
+        : Base(name, params, c)
+    {}
+
+    FastSlave(sc_core::sc_module_name name, const Parameters &params, ConfigManager &c, const std::string &port_name)
+        : Base(name, params, c, port_name)
+    {}
+
+    virtual ~FastSlave() {}
+
+    virtual void b_transport(tlm::tlm_generic_payload& trans, sc_core::sc_time& delay)
+    {
+        this->serve_transport(trans, delay,
+                              [this] (bool is_write, uint64_t addr, uint8_t *data,
+                                      unsigned int len, bool &bErr) {
+            access(is_write, addr, data, len, bErr);
+        });
+    }
+};
+
+#undef FAST_SLAVE_INHERITED
+
+#endif
@@ -25,29 +25,130 @@
 #ifndef _MASTER_DEVICE_H_
 #define _MASTER_DEVICE_H_
 
+#include <deque>
+
 #include <systemc>
+#include <tlm_utils/peq_with_cb_and_phase.h>
 
 #include "rabbits/logger.h"
 #include "rabbits/component/component.h"
 #include "rabbits/component/port/tlm_initiator.h"
+#include "rabbits/datatypes/tlm_payload_pool.h"
 
 /**
  * @brief Master (initiator) component on a bus.
  *
  * Represent a component that is connected as a master (a initiator) on a bus.
+ *
+ * Besides the blocking bus_read() and bus_write() methods, the master can
+ * issue non-blocking accesses following the four phases of the TLM base
+ * protocol (see nb_bus_access()). Several of them can be outstanding at the
+ * same time, so that pipelined traffic can be modelled.
  */
 template <unsigned int BUSWIDTH = 32>
 class Master: public Component, public tlm::tlm_bw_transport_if<>
 {
+protected:
+    tlm_utils::peq_with_cb_and_phase<Master> m_peq;
+    TlmPayloadPool m_nb_pool;
+
+    /* Requests waiting for the previous one to be accepted */
+    std::deque<tlm::tlm_generic_payload*> m_nb_pending;
+
+    /* Request waiting for END_REQ */
+    tlm::tlm_generic_payload *m_nb_req = nullptr;
+
+    unsigned int m_nb_outstanding = 0;
+    sc_core::sc_event m_nb_done_ev;
+
+    void nb_send_request(tlm::tlm_generic_payload &trans)
+    {
+        tlm::tlm_phase phase = tlm::BEGIN_REQ;
+        sc_core::sc_time t = sc_core::SC_ZERO_TIME;
+
+        m_nb_req = &trans;
+
+        switch (p_bus.socket->nb_transport_fw(trans, phase, t)) {
+        case tlm::TLM_ACCEPTED:
+            /* END_REQ will come on the backward path */
+            break;
+
+        case tlm::TLM_UPDATED:
+            m_peq.notify(trans, phase, t);
+            break;
+
+        case tlm::TLM_COMPLETED:
+            /* The target skipped the remaining phases */
+            m_peq.notify(trans, tlm::END_RESP, t);
+            break;
+        }
+    }
+
+    void nb_end_request(tlm::tlm_generic_payload &trans)
+    {
+        if (m_nb_req != &trans) {
+            return;
+        }
+
+        m_nb_req = nullptr;
+
+        if (!m_nb_pending.empty()) {
+            tlm::tlm_generic_payload *next = m_nb_pending.front();
+            m_nb_pending.pop_front();
+            nb_send_request(*next);
+        }
+    }
+
+    void nb_complete(tlm::tlm_generic_payload &trans)
+    {
+        nb_end_request(trans);
+
+        m_nb_outstanding--;
+        nb_bus_access_done(trans);
+        m_nb_pool.release(&trans);
+        m_nb_done_ev.notify();
+    }
+
+    void peq_cb(tlm::tlm_generic_payload &trans, const tlm::tlm_phase &phase)
+    {
+        switch (phase) {
+        case tlm::END_REQ:
+            nb_end_request(trans);
+            break;
+
+        case tlm::BEGIN_RESP:
+            {
+                /* Response given by the return path of the request */
+                tlm::tlm_phase fw_phase = tlm::END_RESP;
+                sc_core::sc_time t = sc_core::SC_ZERO_TIME;
+
+                p_bus.socket->nb_transport_fw(trans, fw_phase, t);
+                nb_complete(trans);
+            }
+            break;
+
+        case tlm::END_RESP:
+            nb_complete(trans);
+            break;
+
+        default:
+            MLOG(SIM, ERR) << "Unexpected phase on non-blocking transport\n";
+            break;
+        }
+    }
+
 public:
     TlmInitiatorPort<BUSWIDTH> p_bus;
 
     Master(sc_core::sc_module_name name, ConfigManager &config)
-        : Component(name, Parameters(), config), p_bus("mem", *this) {}
+        : Component(name, Parameters(), config)
+        , m_peq(this, &Master::peq_cb), p_bus("mem", *this) {}
     Master(sc_core::sc_module_name name, const Parameters &params, ConfigManager &config)
-        : Component(name, params, config), p_bus("mem", *this) {}
+        : Component(name, params, config)
+        , m_peq(this, &Master::peq_cb), p_bus("mem", *this) {}
     Master(sc_core::sc_module_name name, const Parameters &params, ConfigManager &config, const std::string &port_name)
-        : Component(name, params, config), p_bus(port_name, *this) {}
+        : Component(name, params, config)
+        , m_peq(this, &Master::peq_cb), p_bus(port_name, *this) {}
 
     virtual ~Master() {}
 
@@ -75,21 +176,226 @@ public:
         p_bus.bus_write(addr, data, len);
     }
 
+    /**
+     * @brief Emit an exclusive read (load-linked) request on the bus.
+     *
+     * @param[in] addr Address of the read request.
+     * @param[in,out] data Array where read result must be written.
+     * @param[in] len Length of the read request.
+     *
+     * @return true if the target has set a reservation.
+     */
+    bool bus_read_exclusive(uint64_t addr, uint8_t *data, unsigned int len)
+    {
+        return p_bus.bus_read_exclusive(addr, data, len);
+    }
+
+    /**
+     * @brief Emit an exclusive write (store-conditional) request on the bus.
+     *
+     * @param[in] addr Address of the write request.
+     * @param[in] data Array containing the data of the write request.
+     * @param[in] len Length of the write request.
+     *
+     * @return true if the write has been performed.
+     */
+    bool bus_write_exclusive(uint64_t addr, uint8_t *data, unsigned int len)
+    {
+        return p_bus.bus_write_exclusive(addr, data, len);
+    }
+
+    /**
+     * @brief Emit a sequence of read requests on the bus.
+     *
+     * @param[in,out] desc Array of access descriptors.
+     * @param[in] count Number of elements in desc.
+     *
+     * @return the number of elements that completed successfully.
+     *
+     * @see TlmInitiatorPort::bus_access_v
+     */
+    unsigned int bus_read_v(BusAccessDescriptor *desc, unsigned int count)
+    {
+        return p_bus.bus_read_v(desc, count);
+    }
+
+    /**
+     * @brief Emit a sequence of write requests on the bus.
+     *
+     * @param[in,out] desc Array of access descriptors.
+     * @param[in] count Number of elements in desc.
+     *
+     * @return the number of elements that completed successfully.
+     *
+     * @see TlmInitiatorPort::bus_access_v
+     */
+    unsigned int bus_write_v(BusAccessDescriptor *desc, unsigned int count)
+    {
+        return p_bus.bus_write_v(desc, count);
+    }
+
+    /**
+     * @brief Return the preallocated extension of the given type.
+     *
+     * It is attached to all the subsequent blocking accesses of the master.
+     *
+     * @see TlmInitiatorPort::get_extension_slot
+     */
+    template <class EXT>
+    EXT & get_extension_slot()
+    {
+        return p_bus.template get_extension_slot<EXT>();
+    }
+
+    /**
+     * @brief Send the pending combined write of the master, if any.
+     *
+     * @see TlmInitiatorPort::flush_write_buffer
+     */
+    BusAccessResponseStatus flush_write_buffer()
+    {
+        return p_bus.flush_write_buffer();
+    }
+
+    /**
+     * @brief Return the local time offset of the master.
+     *
+     * @see TlmInitiatorPort::get_local_time
+     */
+    sc_core::sc_time get_local_time() const
+    {
+        return p_bus.get_local_time();
+    }
+
+    /**
+     * @brief Add computation time to the local time offset of the master.
+     *
+     * @param[in] t The time to add.
+     */
+    void inc_local_time(const sc_core::sc_time &t)
+    {
+        p_bus.inc_local_time(t);
+    }
+
+    /**
+     * @brief Synchronize the master with the SystemC kernel.
+     *
+     * Must be called before waiting on an event.
+     */
+    void sync()
+    {
+        p_bus.sync();
+    }
+
+    /**
+     * @brief Emit a non-blocking access on the bus the master is connected to.
+     *
+     * The access is sent right away if the bus has accepted all the previous
+     * requests, and queued otherwise. The method returns without waiting for
+     * the response. nb_bus_access_done() is called once the access is
+     * complete. Until then, the data array must remain valid.
+     *
+     * @param[in] cmd Command of the access.
+     * @param[in] addr Address of the access.
+     * @param[in,out] data Array containing the data of the access.
+     * @param[in] len Length of the access.
+     *
+     * @return the payload of the access, valid until its completion.
+     */
+    tlm::tlm_generic_payload * nb_bus_access(tlm::tlm_command cmd, uint64_t addr,
+                                             uint8_t *data, unsigned int len)
+    {
+        /* Keep the ordering with the combined writes */
+        p_bus.flush_write_buffer();
+
+        tlm::tlm_generic_payload *trans = m_nb_pool.acquire();
+
+        trans->set_command(cmd);
+        trans->set_address(addr);
+        trans->set_data_ptr(data);
+        trans->set_data_length(len);
+        trans->set_streaming_width(len);
+        trans->set_byte_enable_ptr(nullptr);
+        trans->set_dmi_allowed(false);
+        trans->set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
+
+        m_nb_outstanding++;
+
+        if (m_nb_req == nullptr) {
+            nb_send_request(*trans);
+        } else {
+            m_nb_pending.push_back(trans);
+        }
+
+        return trans;
+    }
+
+    /**
+     * @brief Emit a non-blocking read request.
+     *
+     * @see nb_bus_access
+     */
+    tlm::tlm_generic_payload * nb_bus_read(uint64_t addr, uint8_t *data, unsigned int len)
+    {
+        return nb_bus_access(tlm::TLM_READ_COMMAND, addr, data, len);
+    }
+
+    /**
+     * @brief Emit a non-blocking write request.
+     *
+     * @see nb_bus_access
+     */
+    tlm::tlm_generic_payload * nb_bus_write(uint64_t addr, uint8_t *data, unsigned int len)
+    {
+        return nb_bus_access(tlm::TLM_WRITE_COMMAND, addr, data, len);
+    }
+
+    /**
+     * @brief Called when a non-blocking access is complete.
+     *
+     * The Master class implementation does nothing. The payload goes back to
+     * the pool when this method returns.
+     *
+     * @param[in] trans The payload of the completed access.
+     */
+    virtual void nb_bus_access_done(tlm::tlm_generic_payload &trans) {}
+
+    /**
+     * @brief Return the number of non-blocking accesses not yet complete.
+     */
+    unsigned int get_nb_outstanding() const { return m_nb_outstanding; }
+
+    /**
+     * @brief Wait for all the non-blocking accesses to complete.
+     *
+     * Must be called from a SystemC thread.
+     */
+    void wait_nb_outstanding()
+    {
+        while (m_nb_outstanding) {
+            sc_core::wait(m_nb_done_ev);
+        }
+    }
+
     /* tlm::tlm_bw_transport_if */
     virtual tlm::tlm_sync_enum nb_transport_bw(tlm::tlm_generic_payload& trans,
                                                tlm::tlm_phase& phase,
                                                sc_core::sc_time& t)
     {
-        LOG(SIM, ERR) << "Non-blocking transport not implemented\n";
-        abort();
-        return tlm::TLM_COMPLETED;
+        if (phase == tlm::BEGIN_RESP) {
+            /* The response is consumed right away */
+            m_peq.notify(trans, tlm::END_RESP, t);
+            return tlm::TLM_COMPLETED;
+        }
+
+        m_peq.notify(trans, phase, t);
+        return tlm::TLM_ACCEPTED;
     }
 
     virtual void invalidate_direct_mem_ptr(sc_dt::uint64 start_range,
                                            sc_dt::uint64 end_range)
     {
-        LOG(SIM, ERR) << "DMI memory invalidation not implemented\n";
-        abort();
+        p_bus.invalidate_direct_mem_ptr(start_range, end_range);
     }
 };
 
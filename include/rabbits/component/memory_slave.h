@@ -0,0 +1,311 @@
+/*
+ *  This file is part of Rabbits
+ *  Copyright (C) 2017  Clement Deschamps and Luc Michel
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/**
+ * @file memory_slave.h
+ * @brief MemorySlave class declaration
+ */
+
+#ifndef _RABBITS_COMPONENT_MEMORY_SLAVE_H
+#define _RABBITS_COMPONENT_MEMORY_SLAVE_H
+
+#include <cstring>
+
+#include "rabbits/component/slave.h"
+#include "rabbits/datatypes/backing_store.h"
+#include "rabbits/datatypes/exclusive_monitor.h"
+#include "rabbits/datatypes/tlm_exclusive.h"
+
+/**
+ * @brief Base class for memory-like slave components.
+ *
+ * @tparam BUSWIDTH Width of the bus the slave will be connected to.
+ *
+ * The memory content lives in a contiguous BackingStore. Bus accesses are
+ * served with a memory copy and annotated with the fixed `read-latency` and
+ * `write-latency` of the slave. Per range latencies are not supported, as DMI
+ * is granted on the whole memory, with the same latencies. A read-only memory (ROM)
+ * rejects bus writes and only grants read DMI access. Debug accesses always
+ * succeed within the memory bounds.
+ *
+ * Exclusive accesses (see TlmExclusiveExtension) are tracked by an
+ * ExclusiveMonitor. Reserved granules are revoked from the DMI grants and kept
+ * out of the new ones, so that every write that may break a reservation goes
+ * through b_transport() while the other initiators keep their DMI access to
+ * the rest of the memory.
+ */
+template <unsigned int BUSWIDTH = 32>
+class MemorySlave : public Slave<BUSWIDTH> {
+protected:
+    BackingStore m_store;
+
+    bool m_readonly = false;
+    bool m_dmi_enabled = true;
+
+    /* Set when a DMI pointer has been handed out since the last full revoke */
+    bool m_dmi_granted = false;
+
+    using Slave<BUSWIDTH>::m_read_latency;
+    using Slave<BUSWIDTH>::m_write_latency;
+
+    ExclusiveMonitor m_monitor;
+
+    bool in_bounds(uint64_t addr, uint64_t len) const
+    {
+        return (len <= m_store.size()) && (addr <= m_store.size() - len);
+    }
+
+    uint64_t clamp(uint64_t addr, uint64_t len) const
+    {
+        if (addr >= m_store.size()) {
+            return 0;
+        }
+
+        return std::min(len, m_store.size() - addr);
+    }
+
+    /* Return false if the access must not be performed */
+    bool exclusive_access(tlm::tlm_generic_payload &trans, TlmExclusiveExtension &ex)
+    {
+        const uint64_t addr = trans.get_address();
+
+        if (trans.is_read()) {
+            const AddressRange r = m_monitor.reserve(ex.get_initiator(), addr);
+            revoke_dmi(r.begin(), r.end());
+            ex.set_ok(true);
+        } else {
+            ex.set_ok(m_monitor.store_exclusive(ex.get_initiator(), addr,
+                                                trans.get_data_length()));
+        }
+
+        return ex.is_ok();
+    }
+
+public:
+    MemorySlave(sc_core::sc_module_name name, const Parameters &params,
+                ConfigManager &c, uint64_t size)
+        : Slave<BUSWIDTH>(name, params, c), m_store(size)
+    {}
+
+    MemorySlave(sc_core::sc_module_name name, ConfigManager &c, uint64_t size)
+        : Slave<BUSWIDTH>(name, c), m_store(size)
+    {}
+
+    virtual ~MemorySlave() {}
+
+    uint8_t * get_data() { return m_store.data(); }
+    uint64_t get_size() const { return m_store.size(); }
+
+    ExclusiveMonitor & get_monitor() { return m_monitor; }
+
+    /**
+     * @brief Make the memory read-only for bus accesses.
+     *
+     * Write DMI grants are revoked when switching to read-only.
+     */
+    void set_readonly(bool readonly)
+    {
+        if (readonly && !m_readonly) {
+            revoke_dmi();
+        }
+
+        m_readonly = readonly;
+    }
+
+    bool is_readonly() const { return m_readonly; }
+
+    /**
+     * @brief Set the latency annotated on each bus access and DMI grant.
+     */
+    void set_latencies(const sc_core::sc_time &read, const sc_core::sc_time &write)
+    {
+        revoke_dmi();
+        Slave<BUSWIDTH>::set_latencies(read, write);
+    }
+
+    /**
+     * @brief Allow or forbid DMI on this memory.
+     *
+     * Forbidding DMI revokes all the grants.
+     */
+    void set_dmi_enabled(bool enabled)
+    {
+        if (!enabled) {
+            revoke_dmi();
+        }
+
+        m_dmi_enabled = enabled;
+    }
+
+    /**
+     * @brief Revoke the DMI grants overlapping a range.
+     *
+     * The invalidation goes through the backward path to every initiator that
+     * may hold a pointer on the range, e.g. before a side effect on the memory
+     * content that must be observed.
+     *
+     * @param[in] start Start address of the range, local to the memory.
+     * @param[in] end End address (inclusive) of the range.
+     */
+    void revoke_dmi(uint64_t start, uint64_t end)
+    {
+        if (m_dmi_granted) {
+            this->p_bus.socket->invalidate_direct_mem_ptr(start, end);
+        }
+    }
+
+    /**
+     * @brief Revoke all the DMI grants on this memory.
+     */
+    void revoke_dmi()
+    {
+        if (m_store.size()) {
+            revoke_dmi(0, m_store.size() - 1);
+        }
+
+        m_dmi_granted = false;
+    }
+
+    void bus_cb_read(uint64_t addr, uint8_t *data, unsigned int len, bool &bErr)
+    {
+        if (!in_bounds(addr, len)) {
+            bErr = true;
+            return;
+        }
+
+        std::memcpy(data, m_store.data() + addr, len);
+    }
+
+    void bus_cb_write(uint64_t addr, uint8_t *data, unsigned int len, bool &bErr)
+    {
+        if (m_readonly || !in_bounds(addr, len)) {
+            bErr = true;
+            return;
+        }
+
+        std::memcpy(m_store.data() + addr, data, len);
+    }
+
+    uint64_t debug_read(uint64_t addr, uint8_t *buf, uint64_t size)
+    {
+        size = clamp(addr, size);
+        std::memcpy(buf, m_store.data() + addr, size);
+        return size;
+    }
+
+    uint64_t debug_write(uint64_t addr, const uint8_t *buf, uint64_t size)
+    {
+        size = clamp(addr, size);
+        std::memcpy(m_store.data() + addr, buf, size);
+        return size;
+    }
+
+    virtual void b_transport(tlm::tlm_generic_payload &trans, sc_core::sc_time &delay)
+    {
+        const sc_core::sc_time start = delay;
+        const uint64_t addr = trans.get_address();
+        const unsigned int len = trans.get_data_length();
+        uint8_t *data = trans.get_data_ptr();
+        TlmExclusiveExtension *ex = trans.get_extension<TlmExclusiveExtension>();
+        const bool split = trans.get_byte_enable_ptr()
+            || (trans.get_streaming_width() && (trans.get_streaming_width() < len));
+
+        /* Keep the initiator information reachable, as in Slave::b_transport */
+        tlm::tlm_generic_payload *prev = this->m_cur_trans;
+        this->m_cur_trans = &trans;
+
+        /* Validate the access first, a failing one must not touch the reservations */
+        if (!split && !in_bounds(addr, len)) {
+            trans.set_response_status(tlm::TLM_ADDRESS_ERROR_RESPONSE);
+        } else if (trans.is_write() && m_readonly) {
+            trans.set_response_status(tlm::TLM_COMMAND_ERROR_RESPONSE);
+        } else if (ex && !exclusive_access(trans, *ex)) {
+            /* Failed store-exclusive, the memory is left untouched */
+            delay += m_write_latency;
+            trans.set_response_status(tlm::TLM_OK_RESPONSE);
+        } else if (split) {
+            /* Rare case, let Slave cut the transaction */
+            Slave<BUSWIDTH>::b_transport(trans, delay);
+
+            if (trans.is_write() && trans.is_response_ok() && !m_monitor.empty()) {
+                m_monitor.write(addr, len);
+            }
+
+            this->m_cur_trans = prev;
+            return;
+        } else if (trans.is_read()) {
+            std::memcpy(data, m_store.data() + addr, len);
+            delay += m_read_latency;
+            trans.set_response_status(tlm::TLM_OK_RESPONSE);
+        } else if (trans.is_write()) {
+            if (!ex && !m_monitor.empty()) {
+                m_monitor.write(addr, len);
+            }
+
+            std::memcpy(m_store.data() + addr, data, len);
+            delay += m_write_latency;
+            trans.set_response_status(tlm::TLM_OK_RESPONSE);
+        } else {
+            trans.set_response_status(tlm::TLM_COMMAND_ERROR_RESPONSE);
+        }
+
+        trans.set_dmi_allowed(m_dmi_enabled && trans.is_response_ok()
+                              && (ex == nullptr)
+                              && (m_monitor.empty() || !m_monitor.is_reserved(addr, len)));
+
+        this->p_bus.get_stats().record(trans.is_write(), len, trans.is_response_error(), false,
+                                       trans.is_write() ? m_write_latency : m_read_latency);
+
+        if (this->p_bus.is_recording()) {
+            this->p_bus.record(trans, start);
+        }
+
+        this->m_cur_trans = prev;
+    }
+
+    virtual bool get_direct_mem_ptr(tlm::tlm_generic_payload &trans,
+                                    tlm::tlm_dmi &dmi_data)
+    {
+        uint64_t start = 0;
+        uint64_t end = m_store.size() - 1;
+
+        if (!m_dmi_enabled || (trans.get_address() >= m_store.size())) {
+            return false;
+        }
+
+        if (!m_monitor.empty() && !m_monitor.clamp(trans.get_address(), start, end)) {
+            return false;
+        }
+
+        dmi_data.set_dmi_ptr(m_store.data() + start);
+        dmi_data.set_start_address(start);
+        dmi_data.set_end_address(end);
+        dmi_data.set_granted_access(m_readonly ? tlm::tlm_dmi::DMI_ACCESS_READ
+                                               : tlm::tlm_dmi::DMI_ACCESS_READ_WRITE);
+        dmi_data.set_read_latency(m_read_latency);
+        dmi_data.set_write_latency(m_write_latency);
+
+        m_dmi_granted = true;
+        this->p_bus.get_stats().dmi_grants++;
+
+        return true;
+    }
+};
+
+#endif
@@ -134,6 +134,15 @@ protected:
 
     void add_attr_to_parent(const std::string & key, const std::string & value);
 
+    /* Return the value of a boolean global parameter, false if the port has no parent */
+    bool get_global_flag(const std::string & key) const;
+
+    /* Return the value of a string global parameter, empty if the port has no parent */
+    std::string get_global_string(const std::string & key) const;
+
+    /* Return the value of an unsigned global parameter, 0 if the port has no parent */
+    uint32_t get_global_uint(const std::string & key) const;
+
     template <class Callback>
     void push_thread_to_parent(Callback c) {
         if (!m_parent) {
@@ -20,9 +20,19 @@
 #ifndef _RABBITS_COMPONENT_PORT_TLM_INITIATOR_H
 #define _RABBITS_COMPONENT_PORT_TLM_INITIATOR_H
 
+#include <cstring>
+
+#include <tlm_utils/tlm_quantumkeeper.h>
+
 #include "rabbits/component/port.h"
 #include "rabbits/component/connection_strategy/tlm_initiator_target.h"
 #include "rabbits/component/connection_strategy/tlm_initiator_bus.h"
+#include "rabbits/datatypes/tlm_payload_pool.h"
+#include "rabbits/datatypes/dmi_cache.h"
+#include "rabbits/datatypes/tlm_port_stats.h"
+#include "rabbits/datatypes/tlm_exclusive.h"
+#include "rabbits/datatypes/tlm_extension_slots.h"
+#include "rabbits/datatypes/address_map.h"
 
 template <unsigned int BUSWIDTH = 32>
 class TlmInitiatorPort : public Port {
@@ -38,10 +48,44 @@ private:
 
     TlmInitiatorTargetCS<BUSWIDTH, 1> m_init_target_cs;
     TlmInitiatorBusCS<BUSWIDTH> m_initiator_bus_cs;
-    mode_e m_mode;
+    mode_e m_mode = BUS;
 
     BusAccessResponseStatus m_last_access = BusAccessResponseStatus::OK;
 
+    /* Payloads are reused across accesses to avoid heap allocations */
+    TlmPayloadPool m_payload_pool;
+
+    bool m_dmi_enabled = false;
+    DmiCache m_dmi_cache;
+
+    /* Local time offset of the initiator, for temporal decoupling */
+    tlm_utils::tlm_quantumkeeper m_qk;
+
+    TlmPortStats m_stats;
+
+    /* Attached to the payload of exclusive accesses */
+    TlmExclusiveExtension m_exclusive;
+
+    /* Attached to the payload of every blocking access */
+    TlmExtensionSlots m_ext_slots;
+
+    /* Write combining buffer */
+    enum {
+        WC_BUFFER_SIZE = 64, /* Largest combined write */
+        WC_MAX_WRITE = 8,    /* Largest write considered for combining */
+    };
+
+    bool m_wc_enabled = false;
+    AddressMap<bool> m_wc_ranges;
+    AddressRange m_wc_range;
+    uint64_t m_wc_addr = 0;
+    unsigned int m_wc_len = 0;
+    uint8_t m_wc_data[WC_BUFFER_SIZE];
+
+    /* Error of a flushed combined write, reported until it is read */
+    /* Error of a combined write, reported along with the access flushing it */
+    BusAccessResponseStatus m_wc_error = BusAccessResponseStatus::OK;
+
     mutable std::string m_typeid;
 
     void init() {
@@ -52,6 +96,225 @@ private:
         add_attr_to_parent("tlm-initiator-port", Port::name());
     }
 
+    bool dmi_request(tlm::tlm_command cmd, uint64_t addr, DmiInfo & info)
+    {
+        tlm::tlm_generic_payload &trans = *m_payload_pool.acquire();
+        tlm::tlm_dmi dmi_data;
+        bool granted;
+
+        trans.set_address(static_cast<sc_dt::uint64>(addr));
+        trans.set_command(cmd);
+
+        granted = socket->get_direct_mem_ptr(trans, dmi_data);
+        m_payload_pool.release(&trans);
+
+        if (granted) {
+            info.ptr = static_cast<void*>(dmi_data.get_dmi_ptr());
+
+            info.range = AddressRange(dmi_data.get_start_address(),
+                                      dmi_data.get_end_address() - dmi_data.get_start_address() + 1);
+
+            info.read_allowed = dmi_data.is_read_allowed();
+            info.write_allowed = dmi_data.is_write_allowed();
+
+            info.read_latency = dmi_data.get_read_latency();
+            info.write_latency = dmi_data.get_write_latency();
+
+            return true;
+        } else {
+            return false;
+        }
+    }
+
+    bool dmi_access(tlm::tlm_command cmd, uint64_t addr,
+                    uint8_t *data, unsigned int len, sc_core::sc_time &delay)
+    {
+        const bool write = (cmd == tlm::TLM_WRITE_COMMAND);
+        const DmiInfo *dmi = m_dmi_cache.lookup(addr, len, write);
+
+        if (dmi == nullptr) {
+            return false;
+        }
+
+        uint8_t *p = static_cast<uint8_t*>(dmi->ptr) + (addr - dmi->range.begin());
+
+        if (write) {
+            std::memcpy(p, data, len);
+            delay += dmi->write_latency;
+        } else {
+            std::memcpy(data, p, len);
+            delay += dmi->read_latency;
+        }
+
+        return true;
+    }
+
+    static bool decoupling_enabled()
+    {
+        return tlm_utils::tlm_quantumkeeper::get_global_quantum() != sc_core::SC_ZERO_TIME;
+    }
+
+    void update_local_time(const sc_core::sc_time &t, bool may_sync = true)
+    {
+        if (!decoupling_enabled()) {
+            return;
+        }
+
+        m_qk.set(t);
+
+        if (may_sync && m_qk.need_sync()) {
+            sync();
+        }
+    }
+
+    /* Add a write to the combining buffer. Return false if it is not combinable */
+    bool wc_write(uint64_t addr, const uint8_t *data, unsigned int len)
+    {
+        if (m_wc_len && (addr == m_wc_addr + m_wc_len)
+            && (len <= WC_BUFFER_SIZE - m_wc_len)
+            && (addr <= m_wc_range.end())
+            && (len - 1 <= m_wc_range.end() - addr)) {
+            std::memcpy(m_wc_data + m_wc_len, data, len);
+            m_wc_len += len;
+        } else {
+            flush_write_buffer();
+
+            const AddressMap<bool>::Entry *e = m_wc_ranges.lookup(addr);
+
+            if ((e == nullptr) || (len - 1 > e->range.end() - addr)) {
+                return false;
+            }
+
+            m_wc_range = e->range;
+            m_wc_addr = addr;
+            std::memcpy(m_wc_data, data, len);
+            m_wc_len = len;
+        }
+
+        m_stats.combined_writes++;
+
+        if (m_wc_len == WC_BUFFER_SIZE) {
+            flush_write_buffer();
+        }
+
+        return true;
+    }
+
+    /* Flag the ranges of the targets accepting write combining on the bus */
+    void wc_collect_ranges()
+    {
+        if ((m_mode != BUS) || !inspector.size()) {
+            return;
+        }
+
+        for (const MemoryMapping &m : inspector->get_memory_mapping_view()) {
+            HasAttributesIface *target = dynamic_cast<HasAttributesIface*>(m.target);
+
+            if ((target != nullptr) && target->has_attr("write-combinable")) {
+                m_wc_ranges.insert(m.range, true);
+            }
+        }
+    }
+
+    void dmi_refill(tlm::tlm_command cmd, uint64_t addr)
+    {
+        DmiInfo info;
+
+        if (!dmi_request(cmd, addr, info)) {
+            return;
+        }
+
+        MLOG_F(SIM, DBG, "DMI granted on range 0x%.8" PRIx64 " - 0x%.8" PRIx64 "\n",
+               info.range.begin(), info.range.end());
+
+        m_stats.dmi_grants++;
+
+        m_dmi_cache.insert(info);
+    }
+
+    /*
+     * Emit an access on the socket, or through DMI, bypassing write combining.
+     * Unless may_sync is set, the initiator does not synchronize even if its
+     * quantum has expired, so that it can be called outside of a thread.
+     */
+    bool transport_access(tlm::tlm_command cmd, uint64_t addr,
+                          uint8_t *data, unsigned int len, bool exclusive,
+                          bool may_sync = true)
+    {
+        const sc_core::sc_time start = m_qk.get_local_time();
+        sc_core::sc_time delay = start;
+
+        if (m_dmi_enabled && !exclusive && dmi_access(cmd, addr, data, len, delay)) {
+            m_last_access = BusAccessResponseStatus::OK;
+            m_stats.record(cmd == tlm::TLM_WRITE_COMMAND, len, false, true, delay - start);
+            update_local_time(delay, may_sync);
+            return true;
+        }
+
+        tlm::tlm_generic_payload &trans = *m_payload_pool.acquire();
+
+        MLOG_F(SIM, TRC, "bus access: addr=%p, data=%p, len=%d\n",
+               (void *) addr, data, len);
+
+        trans.set_command(cmd);
+        trans.set_address(addr);
+        trans.set_data_ptr(data);
+        trans.set_data_length(len);
+        trans.set_streaming_width(len);
+        trans.set_byte_enable_ptr(NULL);
+        trans.set_byte_enable_length(0);
+        trans.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
+        trans.set_dmi_allowed(false);
+
+        if (exclusive) {
+            m_exclusive.set_ok(false);
+            trans.set_extension(&m_exclusive);
+        }
+
+        m_ext_slots.attach(trans);
+        socket->b_transport(trans, delay);
+        m_ext_slots.detach(trans);
+
+        if (exclusive) {
+            trans.clear_extension(&m_exclusive);
+        }
+
+        if (trans.is_response_error()) {
+            MLOG_F(SIM, ERR, "Bus %s error at address 0x%.8" PRIx64 ", access length: %u byte(s)\n",
+                   (cmd == tlm::TLM_READ_COMMAND) ? "read" : "write",
+                   addr, len);
+        } else if (m_dmi_enabled && !exclusive && trans.is_dmi_allowed()) {
+            dmi_refill(cmd, addr);
+        }
+
+        m_last_access = trans.get_response_status();
+        m_payload_pool.release(&trans);
+
+        m_stats.record(cmd == tlm::TLM_WRITE_COMMAND, len,
+                       m_last_access.is_error(), false, delay - start);
+        update_local_time(delay, may_sync);
+
+        return !exclusive || (!m_last_access.is_error() && m_exclusive.is_ok());
+    }
+
+    BusAccessResponseStatus wc_flush(bool may_sync)
+    {
+        if (!m_wc_len) {
+            return BusAccessResponseStatus::OK;
+        }
+
+        const unsigned int len = m_wc_len;
+        m_wc_len = 0;
+
+        transport_access(tlm::TLM_WRITE_COMMAND, m_wc_addr, m_wc_data, len, false, may_sync);
+
+        if (m_last_access.is_error()) {
+            m_wc_error = m_last_access;
+        }
+
+        return m_last_access;
+    }
+
 public:
 
     explicit TlmInitiatorPort(const std::string &name)
@@ -60,6 +323,7 @@ public:
           , inspector("inspector")
           , m_init_target_cs(socket)
           , m_initiator_bus_cs(socket, inspector)
+          , m_exclusive(this)
     {
         init();
     }
@@ -71,6 +335,7 @@ public:
           , inspector("inspector")
           , m_init_target_cs(socket)
           , m_initiator_bus_cs(socket, inspector)
+          , m_exclusive(this)
     {
         init();
         socket.bind(initiator_iface);
@@ -83,6 +348,7 @@ public:
           , inspector("inspector")
           , m_init_target_cs(socket)
           , m_initiator_bus_cs(socket, inspector)
+          , m_exclusive(this)
     {
         init();
         socket.bind(initiator_proxy);
@@ -90,6 +356,24 @@ public:
 
     virtual ~TlmInitiatorPort() {}
 
+    void start_of_simulation()
+    {
+        m_qk.reset();
+
+        if (get_global_flag("write-combining")) {
+            set_write_combining(true);
+        }
+    }
+
+    void end_of_simulation()
+    {
+        if (get_global_flag("tlm-stats")) {
+            std::stringstream ss;
+            m_stats.dump(ss);
+            MLOG(SIM, INF) << "Statistics of " << full_name() << ":\n" << ss.str();
+        }
+    }
+
     void selected_strategy(ConnectionStrategyBase &cs)
     {
         if (&cs == &m_init_target_cs) {
@@ -99,41 +383,145 @@ public:
         }
     }
 
-    void bus_access(tlm::tlm_command cmd, uint64_t addr,
-                    uint8_t *data, unsigned int len)
+    /**
+     * @brief Emit an access on the bus.
+     *
+     * An exclusive access carries a TlmExclusiveExtension and always goes
+     * through the socket, even when DMI is enabled, so that the target can
+     * update its reservation monitor.
+     *
+     * @param[in] cmd Command of the access.
+     * @param[in] addr Address of the access.
+     * @param[in,out] data Array containing the data of the access.
+     * @param[in] len Length of the access.
+     * @param[in] exclusive true for an exclusive access.
+     *
+     * When write combining is enabled, a small write to a combinable target
+     * may only be buffered. It then reports a success, and any error is
+     * reported by get_last_access_status() after the access flushing the
+     * buffer.
+     *
+     * @return false if the access was exclusive and the target did not
+     *         honour it, true otherwise.
+     */
+    bool bus_access(tlm::tlm_command cmd, uint64_t addr,
+                    uint8_t *data, unsigned int len, bool exclusive = false)
     {
-        tlm::tlm_generic_payload trans;
+        assert(data);
 
-        MLOG_F(SIM, TRC, "bus access: addr=%p, data=%p, len=%d\n",
-               (void *) addr, data, len);
+        m_wc_error = BusAccessResponseStatus::OK;
 
-        assert(data);
+        if (m_wc_enabled) {
+            if ((cmd == tlm::TLM_WRITE_COMMAND) && !exclusive
+                && (len - 1 < WC_MAX_WRITE) && wc_write(addr, data, len)) {
+                m_last_access = BusAccessResponseStatus::OK;
+                return true;
+            }
+
+            flush_write_buffer();
+        }
 
-        sc_core::sc_time delay = sc_core::SC_ZERO_TIME;
+        return transport_access(cmd, addr, data, len, exclusive);
+    }
 
-        trans.set_command(cmd);
-        trans.set_address(addr);
-        trans.set_data_ptr(data);
-        trans.set_data_length(len);
-        trans.set_streaming_width(len);
-        trans.set_byte_enable_ptr(NULL);
-        trans.set_byte_enable_length(0);
-        trans.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
-        trans.set_dmi_allowed(false);
-        socket->b_transport(trans, delay);
+    /**
+     * @brief Emit a sequence of accesses on the bus.
+     *
+     * All the elements share the same command and a single payload. Elements
+     * covered by a cached DMI region do not go through the socket at all. The
+     * local time is updated once, after the last element.
+     *
+     * @param[in] cmd Command of the accesses.
+     * @param[in,out] desc Array of access descriptors. Their status field is
+     *                     updated with the outcome of each element.
+     * @param[in] count Number of elements in desc.
+     *
+     * @return the number of elements that completed successfully.
+     */
+    unsigned int bus_access_v(tlm::tlm_command cmd, BusAccessDescriptor *desc,
+                              unsigned int count)
+    {
+        const bool write = (cmd == tlm::TLM_WRITE_COMMAND);
+        const sc_core::sc_time start = m_qk.get_local_time();
+        sc_core::sc_time delay = start;
+        tlm::tlm_generic_payload *trans = nullptr;
+        unsigned int ok = 0;
+
+        m_wc_error = BusAccessResponseStatus::OK;
+        flush_write_buffer();
+
+        m_last_access = BusAccessResponseStatus::OK;
+
+        for (unsigned int i = 0; i < count; i++) {
+            BusAccessDescriptor &d = desc[i];
+            const sc_core::sc_time elt_start = delay;
+
+            assert(d.data);
+
+            if (m_dmi_enabled && dmi_access(cmd, d.addr, d.data, d.len, delay)) {
+                d.status = BusAccessResponseStatus::OK;
+                m_stats.record(write, d.len, false, true, delay - elt_start);
+                ok++;
+                continue;
+            }
+
+            if (trans == nullptr) {
+                trans = m_payload_pool.acquire();
+                trans->set_command(cmd);
+                trans->set_byte_enable_ptr(NULL);
+                trans->set_byte_enable_length(0);
+                m_ext_slots.attach(*trans);
+            }
+
+            trans->set_address(d.addr);
+            trans->set_data_ptr(d.data);
+            trans->set_data_length(d.len);
+            trans->set_streaming_width(d.len);
+            trans->set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
+            trans->set_dmi_allowed(false);
+
+            socket->b_transport(*trans, delay);
+
+            d.status = trans->get_response_status();
+
+            if (d.status.is_error()) {
+                MLOG_F(SIM, ERR, "Bus %s error at address 0x%.8" PRIx64 ", access length: %u byte(s)\n",
+                       write ? "write" : "read", d.addr, d.len);
+
+                if (!m_last_access.is_error()) {
+                    m_last_access = d.status;
+                }
+            } else {
+                ok++;
+
+                if (m_dmi_enabled && trans->is_dmi_allowed()) {
+                    dmi_refill(cmd, d.addr);
+                }
+            }
+
+            m_stats.record(write, d.len, d.status.is_error(), false, delay - elt_start);
+        }
 
-        if (trans.is_response_error()) {
-            MLOG_F(SIM, ERR, "Bus %s error at address 0x%.8" PRIx64 ", access length: %u byte(s)\n",
-                   (cmd == tlm::TLM_READ_COMMAND) ? "read" : "write",
-                   addr, len);
+        if (trans != nullptr) {
+            m_ext_slots.detach(*trans);
+            m_payload_pool.release(trans);
         }
 
-        m_last_access = trans.get_response_status();
+        update_local_time(delay);
+
+        return ok;
     }
 
     unsigned int debug_access(tlm::tlm_command cmd, uint64_t addr, uint8_t *data, unsigned int len)
     {
-        tlm::tlm_generic_payload trans;
+        /*
+         * Make the combined writes visible to the debugger. Debug accesses
+         * may come from outside of a thread, so do not synchronize.
+         */
+        wc_flush(false);
+
+        tlm::tlm_generic_payload &trans = *m_payload_pool.acquire();
+        unsigned int ret;
 
         MLOG_F(SIM, TRC, "debug access: addr=%p, data=%p, len=%d\n",
                (void *) addr, data, len);
@@ -144,7 +532,10 @@ public:
         trans.set_address(addr);
         trans.set_data_ptr(data);
         trans.set_data_length(len);
-        return socket->transport_dbg(trans);
+        ret = socket->transport_dbg(trans);
+
+        m_payload_pool.release(&trans);
+        return ret;
     }
     /**
      * @brief Emit a read request on the bus the master is connected to.
@@ -170,6 +561,46 @@ public:
         bus_access(tlm::TLM_WRITE_COMMAND, addr, data, len);
     }
 
+    /**
+     * @brief Emit a sequence of read requests on the bus.
+     *
+     * @see bus_access_v
+     */
+    unsigned int bus_read_v(BusAccessDescriptor *desc, unsigned int count)
+    {
+        return bus_access_v(tlm::TLM_READ_COMMAND, desc, count);
+    }
+
+    /**
+     * @brief Emit a sequence of write requests on the bus.
+     *
+     * @see bus_access_v
+     */
+    unsigned int bus_write_v(BusAccessDescriptor *desc, unsigned int count)
+    {
+        return bus_access_v(tlm::TLM_WRITE_COMMAND, desc, count);
+    }
+
+    /**
+     * @brief Emit an exclusive read (load-linked) request on the bus.
+     *
+     * @return true if the target has set a reservation.
+     */
+    bool bus_read_exclusive(uint64_t addr, uint8_t *data, unsigned int len)
+    {
+        return bus_access(tlm::TLM_READ_COMMAND, addr, data, len, true);
+    }
+
+    /**
+     * @brief Emit an exclusive write (store-conditional) request on the bus.
+     *
+     * @return true if the write has been performed.
+     */
+    bool bus_write_exclusive(uint64_t addr, uint8_t *data, unsigned int len)
+    {
+        return bus_access(tlm::TLM_WRITE_COMMAND, addr, data, len, true);
+    }
+
 
     unsigned int debug_read(uint64_t addr, uint8_t *data, unsigned int len)
     {
@@ -186,34 +617,212 @@ public:
         return inspector->get_memory_mapping();
     }
 
-    bool dmi_probe(AddressRange range, DmiInfo & info)
+    /**
+     * @brief Find the target mapped at an address on the bus.
+     *
+     * @see MemoryMappingInspectorScIface::lookup_target
+     */
+    bool lookup_target(uint64_t addr, MemoryMapping &mapping, uint64_t &offset)
     {
-        tlm::tlm_generic_payload trans;
-        tlm::tlm_dmi dmi_data;
+        return inspector->lookup_target(addr, mapping, offset);
+    }
 
-        trans.set_address(static_cast<sc_dt::uint64>(range.begin()));
-        trans.set_command(tlm::TLM_READ_COMMAND);
+    /**
+     * @brief Return a view over the targets mapped on the bus.
+     *
+     * @see MemoryMappingInspectorScIface::get_memory_mapping_view
+     */
+    MemoryMappingView get_memory_mapping_view()
+    {
+        return inspector->get_memory_mapping_view();
+    }
 
-        if (socket->get_direct_mem_ptr(trans, dmi_data)) {
-            info.ptr = static_cast<void*>(dmi_data.get_dmi_ptr());
+    /**
+     * @brief Ask the target for a DMI region covering the start of a range.
+     *
+     * The region is not added to the DMI cache of the port.
+     *
+     * @param[in] range The range of interest.
+     * @param[out] info The granted region.
+     * @param[in] cmd The kind of access the region is requested for.
+     *
+     * @return true if a region has been granted.
+     */
+    bool dmi_probe(AddressRange range, DmiInfo & info,
+                   tlm::tlm_command cmd = tlm::TLM_READ_COMMAND)
+    {
+        return dmi_request(cmd, range.begin(), info);
+    }
 
-            info.range = AddressRange(dmi_data.get_start_address(),
-                                      dmi_data.get_end_address() - dmi_data.get_start_address() + 1);
+    /**
+     * @brief Enable or disable the DMI fast path.
+     *
+     * When enabled, the port keeps track of the DMI regions granted by the
+     * targets it accesses. Bus accesses falling entirely into one of them are
+     * served with a simple memory copy, and the DMI latency is annotated
+     * instead of the transport one. Other accesses go through the socket as
+     * usual. A region is requested each time a target marks a transaction as
+     * DMI allowed.
+     *
+     * @param[in] enabled true to enable the DMI fast path.
+     */
+    void set_dmi_enabled(bool enabled)
+    {
+        m_dmi_enabled = enabled;
 
-            info.read_allowed = dmi_data.is_read_allowed();
-            info.write_allowed = dmi_data.is_write_allowed();
+        if (!enabled) {
+            m_dmi_cache.clear();
+        }
+    }
 
-            info.read_latency = dmi_data.get_read_latency();
-            info.write_latency = dmi_data.get_write_latency();
+    bool is_dmi_enabled() const { return m_dmi_enabled; }
 
-            return true;
-        } else {
-            return false;
+    /**
+     * @brief Invalidate the cached DMI regions overlapping an address range.
+     *
+     * This must be called by the backward interface the port socket is bound
+     * to, when a target revokes a DMI grant.
+     *
+     * @param[in] start Start address of the invalidated range.
+     * @param[in] end End address (inclusive) of the invalidated range.
+     */
+    void invalidate_direct_mem_ptr(uint64_t start, uint64_t end)
+    {
+        m_dmi_cache.invalidate(start, end);
+    }
+
+    /**
+     * @brief Return the local time offset of the initiator.
+     *
+     * When a global quantum is set (see the `quantum' global parameter), the
+     * delays annotated by the targets are accumulated in a local time offset
+     * instead of being waited for. The initiator only synchronizes with the
+     * SystemC kernel when its offset exceeds the quantum. When the global
+     * quantum is zero, temporal decoupling is disabled and annotated delays
+     * are ignored.
+     *
+     * @return the local time offset.
+     */
+    sc_core::sc_time get_local_time() const { return m_qk.get_local_time(); }
+
+    /**
+     * @brief Return the current time of the initiator, local offset included.
+     */
+    sc_core::sc_time get_current_time() const { return m_qk.get_current_time(); }
+
+    /**
+     * @brief Add time to the local time offset of the initiator.
+     *
+     * This is meant for the initiator own computation time. The initiator is
+     * synchronized if the offset exceeds the quantum.
+     *
+     * @param[in] t The time to add.
+     */
+    void inc_local_time(const sc_core::sc_time &t)
+    {
+        update_local_time(m_qk.get_local_time() + t);
+    }
+
+    /**
+     * @brief Synchronize the initiator with the SystemC kernel.
+     *
+     * Wait for the local time offset and reset it. This must be called before
+     * blocking on an event, or when the initiator needs other components to
+     * observe its accesses at the right time. It must be called from a
+     * SystemC thread.
+     */
+    void sync()
+    {
+        flush_write_buffer();
+
+        if (m_qk.get_local_time() != sc_core::SC_ZERO_TIME) {
+            m_qk.sync();
         }
     }
 
+    /**
+     * @brief Enable or disable write combining.
+     *
+     * When enabled, adjacent writes of at most 8 bytes to the targets having
+     * the `write-combinable` attribute (see the Slave `write-combinable`
+     * parameter) are merged in a buffer and sent as a single block write. The
+     * buffer is flushed when a write is not adjacent to it, on any other
+     * access, on a barrier (flush_write_buffer()), and when the initiator
+     * synchronizes, i.e. when its quantum expires. It is also enabled on all
+     * the initiators by the `write-combining` global parameter.
+     *
+     * Combinable targets are found through the bus the port is connected to.
+     * Ranges can also be added with add_write_combining_range().
+     *
+     * @param[in] enabled true to enable write combining.
+     */
+    void set_write_combining(bool enabled)
+    {
+        if (!enabled) {
+            flush_write_buffer();
+        } else if (!m_wc_enabled) {
+            wc_collect_ranges();
+        }
+
+        m_wc_enabled = enabled;
+    }
+
+    bool is_write_combining() const { return m_wc_enabled; }
+
+    /**
+     * @brief Allow write combining on an address range.
+     *
+     * @return false if the range overlaps an already combinable one.
+     */
+    bool add_write_combining_range(const AddressRange &range)
+    {
+        return m_wc_ranges.insert(range, true);
+    }
+
+    /**
+     * @brief Send the pending combined write, if any.
+     *
+     * This acts as a write barrier. It must be called from a SystemC thread.
+     * An error on the combined write is also reported by
+     * get_last_access_status(), until the next bus access.
+     *
+     * @return the status of the combined write, OK if there was none.
+     */
+    BusAccessResponseStatus flush_write_buffer()
+    {
+        return wc_flush(true);
+    }
+
+    /**
+     * @brief Return the transaction statistics of the port.
+     */
+    const TlmPortStats & get_stats() const { return m_stats; }
+
+    /**
+     * @brief Return the preallocated extension of the given type.
+     *
+     * The extension is attached to all the subsequent blocking accesses of
+     * the port. Its content can be updated in place between accesses.
+     *
+     * @see TlmExtensionSlots
+     */
+    template <class EXT>
+    EXT & get_extension_slot() { return m_ext_slots.get<EXT>(); }
+
+    void reset_stats() { m_stats.reset(); }
+
+    /**
+     * @brief Return the status of the last access.
+     *
+     * If the last access flushed the write combining buffer and the combined
+     * write failed, the error of the combined write is returned instead.
+     */
     BusAccessResponseStatus get_last_access_status() const
     {
+        if (m_wc_error.is_error()) {
+            return m_wc_error;
+        }
+
         return m_last_access;
     }
 
@@ -20,10 +20,15 @@
 #ifndef _RABBITS_COMPONENT_PORT_TLM_TARGET_H
 #define _RABBITS_COMPONENT_PORT_TLM_TARGET_H
 
+#include <memory>
+
 #include "rabbits/component/port.h"
 #include "rabbits/component/connection_strategy/tlm_initiator_target.h"
 #include "rabbits/component/connection_strategy/tlm_target_bus.h"
 #include "rabbits/datatypes/address_range.h"
+#include "rabbits/datatypes/tlm_port_stats.h"
+#include "rabbits/datatypes/tlm_recorder.h"
+#include "rabbits/datatypes/register_profiler.h"
 
 template <unsigned int BUSWIDTH = 32>
 class TlmTargetPort : public Port {
@@ -34,6 +39,15 @@ private:
     TlmInitiatorTargetCS<BUSWIDTH, 1> m_init_target_cs;
     TlmTargetBusCS<BUSWIDTH> m_target_bus_cs;
 
+    TlmPortStats m_stats;
+
+    TlmRecorder m_recorder;
+    bool m_recording = false;
+
+    /* Only allocated when the profiling is enabled */
+    std::unique_ptr<RegisterProfiler> m_profiler;
+    uint32_t m_profile_top = 0;
+
     mutable std::string m_typeid;
 
     void init() {
@@ -80,6 +94,87 @@ public:
         m_target_bus_cs.register_mapped_ev_listener(l);
     }
 
+    /**
+     * @brief Return the transaction statistics of the port.
+     *
+     * The counters are updated by the target when it handles a transaction.
+     */
+    TlmPortStats & get_stats() { return m_stats; }
+    const TlmPortStats & get_stats() const { return m_stats; }
+
+    void reset_stats() { m_stats.reset(); }
+
+    /**
+     * @brief Return true if the transactions received by the port are recorded.
+     *
+     * Recording is enabled by the `tlm-record' global parameter.
+     */
+    bool is_recording() const { return m_recording; }
+
+    /**
+     * @brief Record a transaction handled by the target.
+     *
+     * @param[in] trans The completed transaction.
+     * @param[in] offset The local time offset of the initiator when the
+     *                   transaction was received.
+     */
+    void record(const tlm::tlm_generic_payload &trans, const sc_core::sc_time &offset)
+    {
+        m_recorder.record(trans, sc_core::sc_time_stamp() + offset);
+    }
+
+    /**
+     * @brief Return the register profiler of the port.
+     *
+     * Profiling is enabled by the `register-profile' global parameter.
+     *
+     * @return the profiler, or nullptr if the profiling is disabled.
+     */
+    RegisterProfiler * get_profiler() { return m_profiler.get(); }
+
+    void start_of_simulation()
+    {
+        m_profile_top = get_global_uint("register-profile");
+
+        if (m_profile_top) {
+            m_profiler.reset(new RegisterProfiler);
+        }
+
+        const std::string dir = get_global_string("tlm-record");
+
+        if (dir.empty()) {
+            return;
+        }
+
+        const std::string fn = dir + "/" + full_name() + ".tlmrec";
+
+        m_recording = m_recorder.open(fn);
+
+        if (!m_recording) {
+            MLOG(SIM, ERR) << "Unable to create transaction recording " << fn << "\n";
+        }
+    }
+
+    void end_of_simulation()
+    {
+        if (m_profiler && m_profiler->size()) {
+            std::stringstream ss;
+            m_profiler->dump(ss, m_profile_top);
+            MLOG(SIM, INF) << "Most accessed registers of " << full_name() << ":\n" << ss.str();
+        }
+
+        if (m_recording) {
+            m_recorder.close();
+            m_recording = false;
+        }
+
+        if (get_global_flag("tlm-stats")) {
+            std::stringstream ss;
+            m_stats.dump(ss);
+            MLOG(SIM, INF) << "Statistics of " << full_name() << ":\n" << ss.str();
+        }
+    }
+
     const char * get_typeid() const
     {
         if (m_typeid.empty()) {
@@ -0,0 +1,419 @@
+/*
+ *  This file is part of Rabbits
+ *  Copyright (C) 2017  Clement Deschamps and Luc Michel
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/**
+ * @file register_bank.h
+ * @brief RegisterBank and RegisterSlave classes declaration
+ */
+
+#ifndef _RABBITS_COMPONENT_REGISTER_BANK_H
+#define _RABBITS_COMPONENT_REGISTER_BANK_H
+
+#include <vector>
+#include <cassert>
+#include <cstdint>
+#include <algorithm>
+
+#include "rabbits/component/slave.h"
+
+/**
+ * @brief Access rights of a register.
+ */
+enum RegisterAccess {
+    REG_RO = 1 << 0,
+    REG_WO = 1 << 1,
+    REG_RW = REG_RO | REG_WO,
+};
+
+/**
+ * @brief Description of a register of a RegisterBank.
+ *
+ * @tparam T The class owning the register hooks.
+ *
+ * Meant to be used in constant tables, e.g.
+ * @code
+ * static constexpr Register<Timer> TIMER_REGS[] = {
+ *     { "ctrl",  0x0, 4, REG_RW, 0, nullptr,           &Timer::ctrl_write },
+ *     { "value", 0x4, 4, REG_RO, 0, &Timer::value_read, nullptr },
+ * };
+ * @endcode
+ *
+ * The read hook is called on each bus read with the stored value, and returns
+ * the value seen by the initiator. The write hook is called on each bus write
+ * with the stored value and the value written by the initiator (already merged
+ * with the stored one for partial writes), and returns the value to store.
+ * Hooks are not called on debug accesses.
+ */
+template <class T>
+struct Register {
+    typedef uint64_t (T::*ReadHook)(uint64_t value);
+    typedef uint64_t (T::*WriteHook)(uint64_t old_value, uint64_t new_value);
+
+    const char *name;
+    uint32_t offset;    /**< Offset in the bank, aligned on the width */
+    unsigned int width; /**< Width in bytes: 1, 2, 4 or 8 */
+    RegisterAccess access;
+    uint64_t reset;
+    ReadHook on_read;
+    WriteHook on_write;
+};
+
+/**
+ * @brief Bank of registers dispatching bus accesses in constant time.
+ *
+ * The register table is turned into an array indexed by the access offset,
+ * divided by the width of the narrowest register. Accesses narrower than a
+ * register, or spanning several consecutive registers, are supported. Values
+ * are stored in the host byte order, and exchanged with the bus in little
+ * endian.
+ */
+template <class T>
+class RegisterBank {
+public:
+    typedef Register<T> Descr;
+
+private:
+    enum { NO_REG = -1 };
+
+    T &m_owner;
+    const Descr *m_table;
+    size_t m_count;
+
+    unsigned int m_shift = 3;
+    std::vector<int16_t> m_index;
+    std::vector<uint64_t> m_values;
+
+    int lookup(uint64_t addr) const
+    {
+        uint64_t idx = addr >> m_shift;
+
+        if (idx >= m_index.size()) {
+            return NO_REG;
+        }
+
+        return m_index[idx];
+    }
+
+    static uint64_t lane_mask(unsigned int len)
+    {
+        return (len >= 8) ? ~uint64_t(0) : ((uint64_t(1) << (len * 8)) - 1);
+    }
+
+    void build_index()
+    {
+        uint64_t size = 0;
+
+        assert(m_count < size_t(INT16_MAX));
+
+        for (size_t i = 0; i < m_count; i++) {
+            const Descr &r = m_table[i];
+
+            assert((r.width == 1) || (r.width == 2) || (r.width == 4) || (r.width == 8));
+            assert((r.offset & (r.width - 1)) == 0);
+
+            while ((1u << m_shift) > r.width) {
+                m_shift--;
+            }
+
+            size = std::max(size, uint64_t(r.offset) + r.width);
+        }
+
+        m_index.assign(size >> m_shift, NO_REG);
+
+        for (size_t i = 0; i < m_count; i++) {
+            const Descr &r = m_table[i];
+
+            for (uint64_t a = r.offset; a < r.offset + r.width; a += (1 << m_shift)) {
+                assert(m_index[a >> m_shift] == NO_REG);
+                m_index[a >> m_shift] = i;
+            }
+        }
+    }
+
+    /* Run fn(register index, offset in register, length) over [addr, addr+len) */
+    template <class F>
+    bool for_each_reg(uint64_t addr, unsigned int len, F fn)
+    {
+        unsigned int done = 0;
+
+        while (done < len) {
+            int i = lookup(addr + done);
+
+            if (i == NO_REG) {
+                return false;
+            }
+
+            const Descr &r = m_table[i];
+            unsigned int lane = addr + done - r.offset;
+            unsigned int chunk = std::min(len - done, r.width - lane);
+
+            if (!fn(i, lane, chunk, done)) {
+                return false;
+            }
+
+            done += chunk;
+        }
+
+        return true;
+    }
+
+    /* Check that [addr, addr+len) only covers registers allowing an access */
+    bool check_access(uint64_t addr, unsigned int len, RegisterAccess access)
+    {
+        return for_each_reg(addr, len,
+            [this, access] (int i, unsigned int, unsigned int, unsigned int) {
+                return (m_table[i].access & access) != 0;
+            });
+    }
+
+    static void to_bus(uint64_t value, unsigned int lane, uint8_t *data, unsigned int len)
+    {
+        for (unsigned int i = 0; i < len; i++) {
+            data[i] = value >> ((lane + i) * 8);
+        }
+    }
+
+    static uint64_t from_bus(uint64_t value, unsigned int lane,
+                             const uint8_t *data, unsigned int len)
+    {
+        uint64_t v = 0;
+
+        for (unsigned int i = 0; i < len; i++) {
+            v |= uint64_t(data[i]) << ((lane + i) * 8);
+        }
+
+        return (value & ~(lane_mask(len) << (lane * 8))) | v;
+    }
+
+public:
+    /**
+     * @brief Build a register bank.
+     *
+     * @param[in] owner The object on which the hooks are called.
+     * @param[in] table The register table. It must outlive the bank.
+     * @param[in] count Number of registers in the table.
+     */
+    RegisterBank(T &owner, const Descr *table, size_t count)
+        : m_owner(owner), m_table(table), m_count(count), m_values(count)
+    {
+        build_index();
+        reset();
+    }
+
+    /**
+     * @brief Set all the registers to their reset value.
+     */
+    void reset()
+    {
+        for (size_t i = 0; i < m_count; i++) {
+            m_values[i] = m_table[i].reset;
+        }
+    }
+
+    /**
+     * @brief Perform a bus read, calling the read hooks.
+     *
+     * All the covered registers are checked before any hook is called, so
+     * that a failing access has no side effect.
+     *
+     * @return false if the access hits a hole or a write-only register.
+     */
+    bool read(uint64_t addr, uint8_t *data, unsigned int len)
+    {
+        if (!check_access(addr, len, REG_RO)) {
+            return false;
+        }
+
+        return for_each_reg(addr, len,
+            [this, data] (int i, unsigned int lane, unsigned int chunk, unsigned int done) {
+                const Descr &r = m_table[i];
+                uint64_t value = m_values[i];
+
+                if (r.on_read) {
+                    value = (m_owner.*r.on_read)(value);
+                }
+
+                to_bus(value, lane, data + done, chunk);
+                return true;
+            });
+    }
+
+    /**
+     * @brief Perform a bus write, calling the write hooks.
+     *
+     * All the covered registers are checked before any hook is called or
+     * any value is stored, so that a failing access has no side effect.
+     *
+     * @return false if the access hits a hole or a read-only register.
+     */
+    bool write(uint64_t addr, const uint8_t *data, unsigned int len)
+    {
+        if (!check_access(addr, len, REG_WO)) {
+            return false;
+        }
+
+        return for_each_reg(addr, len,
+            [this, data] (int i, unsigned int lane, unsigned int chunk, unsigned int done) {
+                const Descr &r = m_table[i];
+                uint64_t value = from_bus(m_values[i], lane, data + done, chunk);
+
+                if (r.on_write) {
+                    value = (m_owner.*r.on_write)(m_values[i], value);
+                }
+
+                m_values[i] = value & lane_mask(r.width);
+                return true;
+            });
+    }
+
+    /**
+     * @brief Perform a debug read, without side effect.
+     *
+     * Stored values are read regardless of the access rights. Holes read as
+     * zero.
+     *
+     * @return the number of bytes read.
+     */
+    uint64_t debug_read(uint64_t addr, uint8_t *data, uint64_t len)
+    {
+        for (uint64_t i = 0; i < len; i++) {
+            int r = lookup(addr + i);
+
+            data[i] = (r == NO_REG) ? 0
+                : m_values[r] >> ((addr + i - m_table[r].offset) * 8);
+        }
+
+        return len;
+    }
+
+    /**
+     * @brief Perform a debug write, without side effect.
+     *
+     * Stored values are written regardless of the access rights. Writes to
+     * holes are ignored.
+     *
+     * @return the number of bytes written.
+     */
+    uint64_t debug_write(uint64_t addr, const uint8_t *data, uint64_t len)
+    {
+        for (uint64_t i = 0; i < len; i++) {
+            int r = lookup(addr + i);
+
+            if (r != NO_REG) {
+                m_values[r] = from_bus(m_values[r], addr + i - m_table[r].offset,
+                                       data + i, 1);
+            }
+        }
+
+        return len;
+    }
+
+    /**
+     * @brief Return the stored value of the register at a given offset.
+     */
+    uint64_t get(uint32_t offset) const
+    {
+        int i = lookup(offset);
+        assert(i != NO_REG);
+        return m_values[i];
+    }
+
+    /**
+     * @brief Set the stored value of the register at a given offset.
+     */
+    void set(uint32_t offset, uint64_t value)
+    {
+        int i = lookup(offset);
+        assert(i != NO_REG);
+        m_values[i] = value & lane_mask(m_table[i].width);
+    }
+
+    /**
+     * @brief Return the size of the address space covered by the bank.
+     */
+    uint64_t size() const { return uint64_t(m_index.size()) << m_shift; }
+};
+
+/**
+ * @brief Slave component whose bus interface is a RegisterBank.
+ *
+ * @tparam Derived The child class, owning the register hooks.
+ * @tparam BUSWIDTH Width of the bus the slave will be connected to.
+ *
+ * Bus and debug accesses are directly handled by the register bank. Streaming
+ * width and byte enables are still handled by Slave::b_transport.
+ */
+template <class Derived, unsigned int BUSWIDTH = 32>
+class RegisterSlave : public Slave<BUSWIDTH> {
+protected:
+    RegisterBank<Derived> m_regs;
+
+public:
+    template <size_t N>
+    RegisterSlave(sc_core::sc_module_name name, const Parameters &params,
+                  ConfigManager &c, const Register<Derived> (&table)[N])
+        : Slave<BUSWIDTH>(name, params, c)
+        , m_regs(static_cast<Derived&>(*this), table, N)
+    {}
+
+    template <size_t N>
+    RegisterSlave(sc_core::sc_module_name name, ConfigManager &c,
+                  const Register<Derived> (&table)[N])
+        : Slave<BUSWIDTH>(name, c)
+        , m_regs(static_cast<Derived&>(*this), table, N)
+    {}
+
+    virtual ~RegisterSlave() {}
+
+    /**
+     * @brief Set all the registers to their reset value.
+     */
+    virtual void reset()
+    {
+        m_regs.reset();
+    }
+
+    void bus_cb_read(uint64_t addr, uint8_t *data, unsigned int len, bool &bErr)
+    {
+        if (!m_regs.read(addr, data, len)) {
+            MLOG_F(SIM, DBG, "Invalid register read at 0x%" PRIx64 " (%u bytes)\n", addr, len);
+            bErr = true;
+        }
+    }
+
+    void bus_cb_write(uint64_t addr, uint8_t *data, unsigned int len, bool &bErr)
+    {
+        if (!m_regs.write(addr, data, len)) {
+            MLOG_F(SIM, DBG, "Invalid register write at 0x%" PRIx64 " (%u bytes)\n", addr, len);
+            bErr = true;
+        }
+    }
+
+    uint64_t debug_read(uint64_t addr, uint8_t *buf, uint64_t size)
+    {
+        return m_regs.debug_read(addr, buf, size);
+    }
+
+    uint64_t debug_write(uint64_t addr, const uint8_t *buf, uint64_t size)
+    {
+        return m_regs.debug_write(addr, buf, size);
+    }
+};
+
+#endif
@@ -25,12 +25,18 @@
 #ifndef _SLAVE_DEVICE_H_
 #define _SLAVE_DEVICE_H_
 
+#include <algorithm>
+#include <deque>
+
 #include <systemc>
+#include <tlm_utils/peq_with_cb_and_phase.h>
 
 #include "rabbits/logger.h"
 
 #include "rabbits/component/component.h"
 #include "rabbits/component/port/tlm_target.h"
+#include "rabbits/datatypes/address_map.h"
+#include "rabbits/datatypes/tlm_initiator_info.h"
 
 /**
  * @brief Slave (target) component on a bus
@@ -38,27 +44,384 @@
  * @tparam BUSWIDTH Width of the bus the slave will be connected to.
  *
  * Represent a component that is connected as a slave (a target) on a bus.
+ *
+ * Non-blocking transactions follow the four phases of the TLM base protocol.
+ * Requests are accepted right away and executed through b_transport() when
+ * their time comes, so the bus_cb_* callbacks serve both blocking and
+ * non-blocking transactions. In that case b_transport() runs in a SystemC
+ * method and must not wait. The response is sent after the delay annotated
+ * by b_transport(). Responses are sent one at a time, in order.
+ *
+ * The timing of the slave can be described in the platform, without any
+ * wait() in the callbacks. b_transport() adds the `read-latency` or
+ * `write-latency` parameter to the annotated delay. A `latencies` list can
+ * override them on some address ranges, relative to the slave base address:
+ *
+ * @code
+ * latencies:
+ *   - address: { 0x100: 0x100 }
+ *     read-latency: 20 ns
+ *     write-latency: 40 ns
+ * @endcode
+ *
+ * Setting the `write-combinable` parameter allows the initiators having
+ * write combining enabled to merge adjacent small writes to this slave into
+ * larger block writes (see TlmInitiatorPort::set_write_combining).
  */
 template <unsigned int BUSWIDTH = 32>
 class Slave: public Component, public tlm::tlm_fw_transport_if<>
 {
+protected:
+    tlm_utils::peq_with_cb_and_phase<Slave> m_peq;
+
+    /* Responses waiting for the previous one to complete */
+    std::deque<tlm::tlm_generic_payload*> m_resp_pending;
+
+    /* Response waiting for END_RESP */
+    tlm::tlm_generic_payload *m_resp = nullptr;
+
+    /* Transaction being served by b_transport() */
+    tlm::tlm_generic_payload *m_cur_trans = nullptr;
+
+    struct AccessLatency {
+        sc_core::sc_time read;
+        sc_core::sc_time write;
+    };
+
+    sc_core::sc_time m_read_latency;
+    sc_core::sc_time m_write_latency;
+    AddressMap<AccessLatency> m_range_latencies;
+
+    void add_latency_param(const std::string &name, const std::string &descr)
+    {
+        if (!m_params.exists(name)) {
+            m_params.add(name, Parameter<sc_core::sc_time>(descr, sc_core::SC_ZERO_TIME, true));
+        }
+    }
+
+    void init_params()
+    {
+        add_latency_param("read-latency", "Latency annotated on each bus read");
+        add_latency_param("write-latency", "Latency annotated on each bus write");
+
+        m_read_latency = m_params["read-latency"].as<sc_core::sc_time>();
+        m_write_latency = m_params["write-latency"].as<sc_core::sc_time>();
+
+        if (!m_params.exists("write-combinable")) {
+            m_params.add("write-combinable",
+                         Parameter<bool>("Allow initiators to merge adjacent writes "
+                                         "to this slave", false, true));
+        }
+
+        if (m_params["write-combinable"].as<bool>()) {
+            add_attr("write-combinable", "true");
+        }
+
+        PlatformDescription &d = m_params.get_base_description();
+
+        if (!d.exists("latencies")) {
+            return;
+        }
+
+        PlatformDescription &ranges = d["latencies"];
+
+        if (!ranges.is_vector()) {
+            MLOG(APP, ERR) << "`latencies` must be a list, ignoring it\n";
+            return;
+        }
+
+        for (unsigned int i = 0; i < ranges.size(); i++) {
+            PlatformDescription &r = ranges[i];
+            AccessLatency l { m_read_latency, m_write_latency };
+            AddressRange range;
+
+            try {
+                range = r["address"].as<AddressRange>();
+
+                if (r.exists("read-latency")) {
+                    l.read = r["read-latency"].as<sc_core::sc_time>();
+                }
+
+                if (r.exists("write-latency")) {
+                    l.write = r["write-latency"].as<sc_core::sc_time>();
+                }
+            } catch (PlatformDescription::InvalidConversionException e) {
+                MLOG(APP, ERR) << "Invalid entry " << i << " in `latencies`: "
+                               << e.what() << "\n";
+                continue;
+            }
+
+            add_range_latency(range, l.read, l.write);
+        }
+    }
+
+    /**
+     * @brief Return the latency of an access at the given offset.
+     */
+    sc_core::sc_time get_latency(bool is_write, uint64_t addr) const
+    {
+        if (!m_range_latencies.empty()) {
+            const typename AddressMap<AccessLatency>::Entry *e = m_range_latencies.lookup(addr);
+
+            if (e != nullptr) {
+                return is_write ? e->value.write : e->value.read;
+            }
+        }
+
+        return is_write ? m_write_latency : m_read_latency;
+    }
+
+    void send_response(tlm::tlm_generic_payload &trans)
+    {
+        tlm::tlm_phase phase = tlm::BEGIN_RESP;
+        sc_core::sc_time t = sc_core::SC_ZERO_TIME;
+
+        m_resp = &trans;
+
+        switch (p_bus.socket->nb_transport_bw(trans, phase, t)) {
+        case tlm::TLM_ACCEPTED:
+            /* END_RESP will come on the forward path */
+            break;
+
+        case tlm::TLM_UPDATED:
+        case tlm::TLM_COMPLETED:
+            m_peq.notify(trans, tlm::END_RESP, t);
+            break;
+        }
+    }
+
+    void end_response(tlm::tlm_generic_payload &trans)
+    {
+        m_resp = nullptr;
+
+        if (trans.has_mm()) {
+            trans.release();
+        }
+
+        if (!m_resp_pending.empty()) {
+            tlm::tlm_generic_payload *next = m_resp_pending.front();
+            m_resp_pending.pop_front();
+            send_response(*next);
+        }
+    }
+
+    void peq_cb(tlm::tlm_generic_payload &trans, const tlm::tlm_phase &phase)
+    {
+        switch (phase) {
+        case tlm::BEGIN_REQ:
+            {
+                sc_core::sc_time delay = sc_core::SC_ZERO_TIME;
+
+                b_transport(trans, delay);
+                m_peq.notify(trans, tlm::BEGIN_RESP, delay);
+            }
+            break;
+
+        case tlm::BEGIN_RESP:
+            if (m_resp == nullptr) {
+                send_response(trans);
+            } else {
+                m_resp_pending.push_back(&trans);
+            }
+            break;
+
+        case tlm::END_RESP:
+            end_response(trans);
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    /* Widest single access a block transfer is split into */
+    static const unsigned int MAX_ACCESS_SIZE =
+        (BUSWIDTH >= 64) ? 8 : (BUSWIDTH >= 32) ? 4 : (BUSWIDTH >= 16) ? 2 : 1;
+
+    void bus_cb_access(bool is_write, uint64_t addr, uint8_t *data,
+                       unsigned int len, bool &bErr)
+    {
+        if (is_write) {
+            bus_cb_write(addr, data, len, bErr);
+        } else {
+            bus_cb_read(addr, data, len, bErr);
+        }
+    }
+
+    /**
+     * @brief Split a block access into naturally aligned accesses.
+     *
+     * Each access is as wide as the alignment of its address and the
+     * remaining length allow, up to max bytes (the bus width by default), and
+     * is handed to access.
+     */
+    template <class ACCESS>
+    static void split_access(ACCESS access, bool is_write, uint64_t addr,
+                             uint8_t *data, unsigned int len, bool &bErr,
+                             unsigned int max = MAX_ACCESS_SIZE)
+    {
+        while (len && !bErr) {
+            unsigned int chunk = max;
+
+            while ((chunk > len) || (addr & (chunk - 1))) {
+                chunk >>= 1;
+            }
+
+            access(is_write, addr, data, chunk, bErr);
+
+            addr += chunk;
+            data += chunk;
+            len -= chunk;
+        }
+    }
+
+    void bus_cb_split(bool is_write, uint64_t addr, uint8_t *data,
+                      unsigned int len, bool &bErr,
+                      unsigned int max = MAX_ACCESS_SIZE)
+    {
+        split_access([this] (bool w, uint64_t a, uint8_t *d, unsigned int l, bool &e) {
+            bus_cb_access(w, a, d, l, e);
+        }, is_write, addr, data, len, bErr, max);
+    }
+
+    /**
+     * @brief Dispatch a transaction with a streaming width or byte enables.
+     *
+     * The transaction is cut in beats of the streaming width, all starting at
+     * the transaction address. Inside a beat, each run of enabled bytes is
+     * handed to access. Disabled bytes are left untouched.
+     */
+    template <class ACCESS>
+    static void dispatch_access(ACCESS access, bool is_write, uint64_t addr,
+                                uint8_t *data, unsigned int len, unsigned int width,
+                                const uint8_t *be, unsigned int be_len, bool &bErr)
+    {
+        if ((width == 0) || (width > len)) {
+            width = len;
+        }
+
+        for (unsigned int beat = 0; (beat < len) && !bErr; beat += width) {
+            const unsigned int beat_len = std::min(width, len - beat);
+
+            if (be == nullptr) {
+                access(is_write, addr, data + beat, beat_len, bErr);
+                continue;
+            }
+
+            unsigned int i = 0;
+
+            while ((i < beat_len) && !bErr) {
+                unsigned int j;
+
+                if (be[(beat + i) % be_len] == TLM_BYTE_DISABLED) {
+                    i++;
+                    continue;
+                }
+
+                for (j = i + 1; j < beat_len; j++) {
+                    if (be[(beat + j) % be_len] == TLM_BYTE_DISABLED) {
+                        break;
+                    }
+                }
+
+                access(is_write, addr + i, data + beat + i, j - i, bErr);
+                i = j;
+            }
+        }
+    }
+
 public:
     TlmTargetPort<BUSWIDTH> p_bus;
 
     Slave(sc_core::sc_module_name name, ConfigManager &c)
-        : Component(name, c), p_bus("mem", *this)
-    {}
+        : Component(name, c), m_peq(this, &Slave::peq_cb), p_bus("mem", *this)
+    {
+        init_params();
+    }
 
     Slave(sc_core::sc_module_name name, const Parameters &params, ConfigManager &c)
-        : Component(name, params, c), p_bus("mem", *this)
-    {}
+        : Component(name, params, c), m_peq(this, &Slave::peq_cb), p_bus("mem", *this)
+    {
+        init_params();
+    }
 
     Slave(sc_core::sc_module_name name, const Parameters &params, ConfigManager &c, const std::string &port_name)
-        : Component(name, params, c), p_bus(port_name, *this)
-    {}
+        : Component(name, params, c), m_peq(this, &Slave::peq_cb), p_bus(port_name, *this)
+    {
+        init_params();
+    }
 
     virtual ~Slave() {}
 
+    /**
+     * @brief Return the transaction currently served by b_transport().
+     *
+     * Valid from the bus_cb_* callbacks only.
+     *
+     * @return the transaction, or nullptr outside of b_transport().
+     */
+    tlm::tlm_generic_payload * get_current_transaction() const { return m_cur_trans; }
+
+    /**
+     * @brief Return an extension of the transaction currently served.
+     *
+     * Meant to be called from the bus_cb_* callbacks, to read the metadata
+     * attached by the initiator (see TlmExtensionSlots).
+     *
+     * @tparam EXT The extension type.
+     *
+     * @return the extension, or nullptr if the initiator did not attach it.
+     */
+    template <class EXT>
+    EXT * get_initiator_extension() const
+    {
+        if (m_cur_trans == nullptr) {
+            return nullptr;
+        }
+
+        return m_cur_trans->get_extension<EXT>();
+    }
+
+    /**
+     * @brief Return the initiator information of the transaction currently served.
+     *
+     * @see get_initiator_extension
+     */
+    const TlmInitiatorInfo * get_initiator_info() const
+    {
+        return get_initiator_extension<TlmInitiatorInfo>();
+    }
+
+    /**
+     * @brief Set the latency annotated on each bus access.
+     */
+    void set_latencies(const sc_core::sc_time &read, const sc_core::sc_time &write)
+    {
+        m_read_latency = read;
+        m_write_latency = write;
+    }
+
+    /**
+     * @brief Set the latency annotated on the bus accesses to a range.
+     *
+     * @param[in] range The range, relative to the slave base address.
+     * @param[in] read The latency of a read access in this range.
+     * @param[in] write The latency of a write access in this range.
+     *
+     * @return false if the range overlaps a range already having its own
+     *         latencies.
+     */
+    bool add_range_latency(const AddressRange &range,
+                           const sc_core::sc_time &read, const sc_core::sc_time &write)
+    {
+        if (!m_range_latencies.insert(range, AccessLatency { read, write })) {
+            MLOG(APP, ERR) << "Latency range " << range << " overlaps another one, ignoring it\n";
+            return false;
+        }
+
+        return true;
+    }
+
 
     /**
      * @brief Callback method on bus read request.
@@ -75,6 +438,8 @@ public:
      * @see bus_cb_read_8
      * @see bus_cb_read_16
      * @see bus_cb_read_32
+     * @see bus_cb_read_64
+     * @see bus_cb_read_block
      */
     virtual void bus_cb_read(uint64_t addr, uint8_t *data, unsigned int len, bool &bErr) {
         switch (len) {
@@ -87,6 +452,12 @@ public:
         case 4:
             bus_cb_read_32(addr, (uint32_t *)data, bErr);
             break;
+        case 8:
+            bus_cb_read_64(addr, (uint64_t *)data, bErr);
+            break;
+        default:
+            bus_cb_read_block(addr, data, len, bErr);
+            break;
         }
     }
 
@@ -147,6 +518,41 @@ public:
         bErr = true;
     }
 
+    /**
+     * @brief Callback method on 64-bit bus read request
+     *
+     * This method is called on a 64-bit bus read request targeted to the component.
+     * The Slave class implementation splits it into accesses of at most
+     * 32 bits, like a block request. Children classes can override it to
+     * handle 64-bit read requests at once.
+     *
+     * @param[in] addr Address of the request.
+     * @param[out] data Array where read result must be written.
+     * @param[out] bErr To be set to true to signal a bus error.
+     *
+     * @see bus_cb_read_32
+     */
+    virtual void bus_cb_read_64(uint64_t addr, uint64_t *value, bool &bErr) {
+        bus_cb_split(false, addr, reinterpret_cast<uint8_t*>(value), sizeof(*value), bErr, 4);
+    }
+
+    /**
+     * @brief Callback method on block bus read request
+     *
+     * This method is called on a bus read request whose length is not 1, 2,
+     * 4 or 8 bytes. The Slave class implementation splits it into naturally
+     * aligned accesses no wider than the bus, and stops on the first error.
+     * Children classes can override it to handle the whole block at once.
+     *
+     * @param[in] addr Address of the request.
+     * @param[out] data Array where read result must be written.
+     * @param[in] len Length of the request.
+     * @param[out] bErr To be set to true to signal a bus error.
+     */
+    virtual void bus_cb_read_block(uint64_t addr, uint8_t *data, unsigned int len, bool &bErr) {
+        bus_cb_split(false, addr, data, len, bErr);
+    }
+
 
     /**
      * @brief Callback method on bus write request.
@@ -163,6 +569,8 @@ public:
      * @see bus_cb_write_8
      * @see bus_cb_write_16
      * @see bus_cb_write_32
+     * @see bus_cb_write_64
+     * @see bus_cb_write_block
      */
     virtual void bus_cb_write(uint64_t addr, uint8_t *data, unsigned int len, bool &bErr) {
         switch (len) {
@@ -175,6 +583,12 @@ public:
         case 4:
             bus_cb_write_32(addr, (uint32_t *)data, bErr);
             break;
+        case 8:
+            bus_cb_write_64(addr, (uint64_t *)data, bErr);
+            break;
+        default:
+            bus_cb_write_block(addr, data, len, bErr);
+            break;
         }
     }
 
@@ -234,6 +648,41 @@ public:
         bErr = true;
     }
 
+    /**
+     * @brief Callback method on 64-bit bus write request
+     *
+     * This method is called on a 64-bit bus write request targeted to the component.
+     * The Slave class implementation splits it into accesses of at most
+     * 32 bits, like a block request. Children classes can override it to
+     * handle 64-bit write requests at once.
+     *
+     * @param[in] addr Address of the request.
+     * @param[in] data Array containing the data of the write request.
+     * @param[out] bErr To be set to true to signal a bus error.
+     *
+     * @see bus_cb_write_32
+     */
+    virtual void bus_cb_write_64(uint64_t addr, uint64_t *value, bool &bErr) {
+        bus_cb_split(true, addr, reinterpret_cast<uint8_t*>(value), sizeof(*value), bErr, 4);
+    }
+
+    /**
+     * @brief Callback method on block bus write request
+     *
+     * This method is called on a bus write request whose length is not 1, 2,
+     * 4 or 8 bytes. The Slave class implementation splits it into naturally
+     * aligned accesses no wider than the bus, and stops on the first error.
+     * Children classes can override it to handle the whole block at once.
+     *
+     * @param[in] addr Address of the request.
+     * @param[in] data Array containing the data of the write request.
+     * @param[in] len Length of the request.
+     * @param[out] bErr To be set to true to signal a bus error.
+     */
+    virtual void bus_cb_write_block(uint64_t addr, uint8_t *data, unsigned int len, bool &bErr) {
+        bus_cb_split(true, addr, data, len, bErr);
+    }
+
     /**
      * @brief Callback method on debug read request.
      *
@@ -294,31 +743,76 @@ public:
                                                tlm::tlm_phase& phase,
                                                sc_core::sc_time& t)
     {
-        LOG(SIM, ERR) << "Non-blocking transport not implemented\n";
-        abort();
-        return tlm::TLM_COMPLETED;
+        switch (phase) {
+        case tlm::BEGIN_REQ:
+            if (trans.has_mm()) {
+                trans.acquire();
+            }
+
+            m_peq.notify(trans, phase, t);
+            phase = tlm::END_REQ;
+            return tlm::TLM_UPDATED;
+
+        case tlm::END_RESP:
+            m_peq.notify(trans, phase, t);
+            return tlm::TLM_COMPLETED;
+
+        default:
+            MLOG(SIM, ERR) << "Unexpected phase on non-blocking transport\n";
+            return tlm::TLM_COMPLETED;
+        }
     }
 
     virtual void b_transport(tlm::tlm_generic_payload& trans, sc_core::sc_time& delay);
     virtual unsigned int transport_dbg(tlm::tlm_generic_payload& trans);
 
+protected:
+    /**
+     * @brief Serve a blocking transaction.
+     *
+     * Does everything b_transport() does around the bus_cb_* callbacks
+     * (latency, statistics, profiling, recording), and hands the accesses the
+     * transaction is made of to access. access is called as
+     * access(is_write, addr, data, len, bErr).
+     */
+    template <class ACCESS>
+    void serve_transport(tlm::tlm_generic_payload& trans, sc_core::sc_time& delay,
+                         ACCESS access);
+
 };
 
 template <unsigned int BUSWIDTH>
 void Slave<BUSWIDTH>::b_transport(tlm::tlm_generic_payload& trans, sc_core::sc_time& delay)
+{
+    serve_transport(trans, delay,
+                    [this] (bool is_write, uint64_t addr, uint8_t *data,
+                            unsigned int len, bool &bErr) {
+        bus_cb_access(is_write, addr, data, len, bErr);
+    });
+}
+
+template <unsigned int BUSWIDTH>
+template <class ACCESS>
+void Slave<BUSWIDTH>::serve_transport(tlm::tlm_generic_payload& trans,
+                                      sc_core::sc_time& delay, ACCESS access)
 {
     bool bErr = false;
+    bool is_write;
 
+    const sc_core::sc_time start = delay;
     uint64_t addr = trans.get_address();
     uint8_t *buf = reinterpret_cast<uint8_t *>(trans.get_data_ptr());
-    uint64_t size = trans.get_data_length();
+    unsigned int size = trans.get_data_length();
+    unsigned int width = trans.get_streaming_width();
+    const uint8_t *be = trans.get_byte_enable_ptr();
+    unsigned int be_len = trans.get_byte_enable_length();
 
     switch (trans.get_command()) {
     case tlm::TLM_WRITE_COMMAND:
-        bus_cb_write(addr, buf, size, bErr);
+        is_write = true;
         break;
     case tlm::TLM_READ_COMMAND:
-        bus_cb_read(addr, buf, size, bErr);
+        is_write = false;
         break;
     default:
         LOG(SIM, ERR) << "Unknown bus access command\n";
@@ -326,8 +820,35 @@ void Slave<BUSWIDTH>::b_transport(tlm::tlm_generic_payload& trans, sc_core::sc_t
         return;
     }
 
+    if (be_len == 0) {
+        be = nullptr;
+    }
+
+    tlm::tlm_generic_payload *prev = m_cur_trans;
+    m_cur_trans = &trans;
+
+    if ((be == nullptr) && ((width == 0) || (width >= size))) {
+        access(is_write, addr, buf, size, bErr);
+    } else {
+        dispatch_access(access, is_write, addr, buf, size, width, be, be_len, bErr);
+    }
+
+    m_cur_trans = prev;
+
     trans.set_response_status(bErr ? tlm::TLM_GENERIC_ERROR_RESPONSE
                                    : tlm::TLM_OK_RESPONSE);
+
+    delay += get_latency(is_write, addr);
+
+    p_bus.get_stats().record(is_write, size, bErr, false, delay - start);
+
+    if (RegisterProfiler *profiler = p_bus.get_profiler()) {
+        profiler->record(addr, is_write);
+    }
+
+    if (p_bus.is_recording()) {
+        p_bus.record(trans, start);
+    }
 }
 
 template <unsigned int BUSWIDTH>
@@ -0,0 +1,159 @@
+/*
+ *  This file is part of Rabbits
+ *  Copyright (C) 2017  Clement Deschamps and Luc Michel
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/**
+ * @file address_map.h
+ * @brief AddressMap class declaration
+ */
+
+#ifndef _RABBITS_DATATYPES_ADDRESS_MAP_H
+#define _RABBITS_DATATYPES_ADDRESS_MAP_H
+
+#include <vector>
+#include <algorithm>
+
+#include "rabbits/datatypes/address_range.h"
+
+/**
+ * @brief Map of non-overlapping address ranges to values.
+ *
+ * @tparam T The type of the values associated to the ranges.
+ *
+ * Ranges are kept sorted by start address, so that a lookup is a binary
+ * search. The last entry hit is remembered and checked first, which makes
+ * consecutive accesses to the same range (the common case) constant time.
+ */
+template <class T>
+class AddressMap {
+public:
+    struct Entry {
+        AddressRange range;
+        T value;
+
+        bool contains(uint64_t addr) const
+        {
+            return (addr >= range.begin()) && (addr - range.begin() < range.size());
+        }
+    };
+
+    typedef typename std::vector<Entry>::const_iterator const_iterator;
+
+private:
+    std::vector<Entry> m_entries;
+    mutable const Entry *m_last = nullptr;
+
+    static bool begins_before(const Entry &e, uint64_t addr)
+    {
+        return e.range.begin() < addr;
+    }
+
+    static bool begins_after(uint64_t addr, const Entry &e)
+    {
+        return addr < e.range.begin();
+    }
+
+public:
+    /**
+     * @brief Insert a range in the map.
+     *
+     * @param[in] range The range to insert.
+     * @param[in] value The value associated to the range.
+     *
+     * @return false if the range is empty or overlaps an already inserted one.
+     */
+    bool insert(const AddressRange &range, const T &value)
+    {
+        if (!range.size()) {
+            return false;
+        }
+
+        typename std::vector<Entry>::iterator it =
+            std::lower_bound(m_entries.begin(), m_entries.end(),
+                             range.begin(), begins_before);
+
+        if ((it != m_entries.end()) && (it->range.begin() <= range.end())) {
+            return false;
+        }
+
+        if ((it != m_entries.begin()) && ((it - 1)->range.end() >= range.begin())) {
+            return false;
+        }
+
+        m_entries.insert(it, Entry { range, value });
+        m_last = nullptr;
+
+        return true;
+    }
+
+    /**
+     * @brief Find the entry containing an address.
+     *
+     * @param[in] addr The address to look for.
+     *
+     * @return the entry, or nullptr if the address is not mapped.
+     */
+    const Entry * lookup(uint64_t addr) const
+    {
+        if (m_last && m_last->contains(addr)) {
+            return m_last;
+        }
+
+        const_iterator it = std::upper_bound(m_entries.begin(), m_entries.end(),
+                                             addr, begins_after);
+
+        if (it == m_entries.begin()) {
+            return nullptr;
+        }
+
+        --it;
+
+        if (!it->contains(addr)) {
+            return nullptr;
+        }
+
+        m_last = &*it;
+        return m_last;
+    }
+
+    /**
+     * @brief Find the first entry ending at or after an address.
+     *
+     * Iterating from the returned iterator gives the entries overlapping
+     * [addr, ...) in address order.
+     */
+    const_iterator lower_bound(uint64_t addr) const
+    {
+        const_iterator it = std::upper_bound(m_entries.begin(), m_entries.end(),
+                                             addr, begins_after);
+
+        if ((it != m_entries.begin()) && ((it - 1)->range.end() >= addr)) {
+            --it;
+        }
+
+        return it;
+    }
+
+    const_iterator begin() const { return m_entries.begin(); }
+    const_iterator end() const { return m_entries.end(); }
+
+    size_t size() const { return m_entries.size(); }
+    bool empty() const { return m_entries.empty(); }
+};
+
+#endif
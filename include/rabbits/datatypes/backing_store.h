@@ -0,0 +1,61 @@
+/*
+ *  This file is part of Rabbits
+ *  Copyright (C) 2017  Clement Deschamps and Luc Michel
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/**
+ * @file backing_store.h
+ * @brief BackingStore class declaration
+ */
+
+#ifndef _RABBITS_DATATYPES_BACKING_STORE_H
+#define _RABBITS_DATATYPES_BACKING_STORE_H
+
+#include <cstdint>
+
+/**
+ * @brief Zero-initialized contiguous memory area backing a memory model.
+ *
+ * On POSIX hosts, the area is an anonymous private mapping, so that pages are
+ * only allocated by the host when first touched. Large, sparsely used
+ * memories are thus cheap.
+ */
+class BackingStore {
+private:
+    uint8_t *m_data = nullptr;
+    uint64_t m_size = 0;
+
+    BackingStore(const BackingStore &);
+    BackingStore & operator= (const BackingStore &);
+
+public:
+    /**
+     * @brief Allocate a backing store.
+     *
+     * @param[in] size Size of the memory area, in bytes.
+     *
+     * @throw RabbitsException if the allocation fails.
+     */
+    explicit BackingStore(uint64_t size);
+    virtual ~BackingStore();
+
+    uint8_t * data() { return m_data; }
+    const uint8_t * data() const { return m_data; }
+    uint64_t size() const { return m_size; }
+};
+
+#endif
@@ -0,0 +1,175 @@
+/*
+ *  This file is part of Rabbits
+ *  Copyright (C) 2017  Clement Deschamps and Luc Michel
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/**
+ * @file dmi_cache.h
+ * @brief DmiCache class declaration
+ */
+
+#ifndef _RABBITS_DATATYPES_DMI_CACHE_H
+#define _RABBITS_DATATYPES_DMI_CACHE_H
+
+#include <vector>
+#include <algorithm>
+
+#include "rabbits/datatypes/tlm.h"
+
+/**
+ * @brief Small table of DMI regions granted to an initiator.
+ *
+ * Entries are kept in most recently used order, so that the regions hit by
+ * the hot code and data of the simulated software are found first. When the
+ * table is full, the least recently used region is dropped.
+ */
+class DmiCache {
+public:
+    static const size_t DEFAULT_MAX_ENTRIES = 8;
+
+private:
+    std::vector<DmiInfo> m_entries;
+    size_t m_max_entries;
+
+    static bool contains(const DmiInfo &info, uint64_t addr, unsigned int len)
+    {
+        const AddressRange &r = info.range;
+
+        return (addr >= r.begin())
+            && (len <= r.size())
+            && (addr - r.begin() <= r.size() - len);
+    }
+
+    void trim()
+    {
+        if (m_entries.size() > m_max_entries) {
+            m_entries.resize(m_max_entries);
+        }
+    }
+
+public:
+    explicit DmiCache(size_t max_entries = DEFAULT_MAX_ENTRIES)
+        : m_max_entries(max_entries)
+    {
+        m_entries.reserve(m_max_entries + 1);
+    }
+
+    /**
+     * @brief Look for a region covering a whole access.
+     *
+     * @param[in] addr Start address of the access.
+     * @param[in] len Length of the access.
+     * @param[in] write true for a write access, false for a read access.
+     *
+     * @return the region, or nullptr if no region allows this access.
+     */
+    const DmiInfo * lookup(uint64_t addr, unsigned int len, bool write)
+    {
+        for (size_t i = 0; i < m_entries.size(); i++) {
+            const DmiInfo &info = m_entries[i];
+
+            if (!contains(info, addr, len)) {
+                continue;
+            }
+
+            if (write ? !info.write_allowed : !info.read_allowed) {
+                return nullptr;
+            }
+
+            if (i) {
+                std::rotate(m_entries.begin(), m_entries.begin() + i,
+                            m_entries.begin() + i + 1);
+            }
+
+            return &m_entries.front();
+        }
+
+        return nullptr;
+    }
+
+    /**
+     * @brief Insert a newly granted region.
+     *
+     * Cached regions overlapping the new one are dropped.
+     *
+     * @param[in] info The granted region.
+     */
+    void insert(const DmiInfo &info)
+    {
+        invalidate(info.range.begin(), info.range.end(), false);
+        m_entries.insert(m_entries.begin(), info);
+        trim();
+    }
+
+    /**
+     * @brief Invalidate an address range.
+     *
+     * Regions entirely contained in the range are dropped. Regions partially
+     * overlapping it are narrowed to the parts lying outside of it.
+     *
+     * @param[in] start Start address of the range.
+     * @param[in] end End address (inclusive) of the range.
+     * @param[in] narrow If false, partially overlapping regions are dropped
+     *                   instead of being narrowed.
+     */
+    void invalidate(uint64_t start, uint64_t end, bool narrow = true)
+    {
+        std::vector<DmiInfo>::iterator it = m_entries.begin();
+
+        while (it != m_entries.end()) {
+            const uint64_t b = it->range.begin();
+            const uint64_t e = it->range.end();
+
+            if ((e < start) || (b > end)) {
+                ++it;
+                continue;
+            }
+
+            DmiInfo info = *it;
+            it = m_entries.erase(it);
+
+            if (!narrow) {
+                continue;
+            }
+
+            if (e > end) {
+                DmiInfo upper = info;
+                upper.ptr = static_cast<uint8_t*>(info.ptr) + (end + 1 - b);
+                upper.range = AddressRange(end + 1, e - end);
+                it = m_entries.insert(it, upper) + 1;
+            }
+
+            if (b < start) {
+                DmiInfo lower = info;
+                lower.range = AddressRange(b, start - b);
+                it = m_entries.insert(it, lower) + 1;
+            }
+        }
+
+        trim();
+    }
+
+    /**
+     * @brief Drop all the cached regions.
+     */
+    void clear() { m_entries.clear(); }
+
+    bool empty() const { return m_entries.empty(); }
+    size_t size() const { return m_entries.size(); }
+};
+
+#endif
@@ -0,0 +1,223 @@
+/*
+ *  This file is part of Rabbits
+ *  Copyright (C) 2017  Clement Deschamps and Luc Michel
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/**
+ * @file exclusive_monitor.h
+ * @brief ExclusiveMonitor class declaration
+ */
+
+#ifndef _RABBITS_DATATYPES_EXCLUSIVE_MONITOR_H
+#define _RABBITS_DATATYPES_EXCLUSIVE_MONITOR_H
+
+#include <vector>
+
+#include "rabbits/datatypes/address_range.h"
+
+/**
+ * @brief Reservation monitor for exclusive accesses.
+ *
+ * Each initiator holds at most one reservation, on an aligned granule of
+ * memory. A reservation is broken by any write overlapping its granule, and
+ * consumed by the next exclusive write of its initiator. Targets and buses
+ * own a monitor and feed it with the accesses they serve.
+ *
+ * Writes done through DMI are not seen by the monitor. Components granting
+ * DMI must keep the reserved granules out of their grants (see clamp()).
+ */
+class ExclusiveMonitor {
+public:
+    static const uint64_t DEFAULT_GRANULE = 64;
+
+private:
+    struct Reservation {
+        const void *initiator;
+        uint64_t granule;
+    };
+
+    std::vector<Reservation> m_reservations;
+    uint64_t m_mask;
+
+    int find(const void *initiator) const
+    {
+        for (size_t i = 0; i < m_reservations.size(); i++) {
+            if (m_reservations[i].initiator == initiator) {
+                return i;
+            }
+        }
+
+        return -1;
+    }
+
+public:
+    /**
+     * @brief Construct a monitor.
+     *
+     * @param[in] granule Size of a reservation granule, a power of two.
+     */
+    explicit ExclusiveMonitor(uint64_t granule = DEFAULT_GRANULE)
+        : m_mask(~(granule - 1))
+    {}
+
+    uint64_t get_granule_size() const { return ~m_mask + 1; }
+
+    /**
+     * @brief Set the reservation of an initiator.
+     *
+     * The previous reservation of the initiator, if any, is dropped.
+     *
+     * @param[in] initiator The initiator identifier.
+     * @param[in] addr The reserved address.
+     *
+     * @return the reserved granule.
+     */
+    AddressRange reserve(const void *initiator, uint64_t addr)
+    {
+        const int i = find(initiator);
+        const Reservation r = { initiator, addr & m_mask };
+
+        if (i < 0) {
+            m_reservations.push_back(r);
+        } else {
+            m_reservations[i] = r;
+        }
+
+        return AddressRange(r.granule, get_granule_size());
+    }
+
+    /**
+     * @brief Check and consume the reservation of an initiator.
+     *
+     * On success, the write is about to be performed and the reservations of
+     * the other initiators on the same granule are broken.
+     *
+     * @param[in] initiator The initiator identifier.
+     * @param[in] addr Address of the exclusive write.
+     * @param[in] len Length of the exclusive write.
+     *
+     * @return true if the exclusive write must be performed.
+     */
+    bool store_exclusive(const void *initiator, uint64_t addr, unsigned int len)
+    {
+        const int i = find(initiator);
+
+        if (i < 0) {
+            return false;
+        }
+
+        const uint64_t granule = m_reservations[i].granule;
+        m_reservations.erase(m_reservations.begin() + i);
+
+        if (((addr & m_mask) != granule) || (((addr + len - 1) & m_mask) != granule)) {
+            return false;
+        }
+
+        write(addr, len);
+        return true;
+    }
+
+    /**
+     * @brief Break the reservations overlapping a write.
+     *
+     * @param[in] addr Address of the write.
+     * @param[in] len Length of the write.
+     *
+     * @return true if at least one reservation has been broken.
+     */
+    bool write(uint64_t addr, unsigned int len)
+    {
+        const uint64_t first = addr & m_mask;
+        const uint64_t last = (addr + len - 1) & m_mask;
+        bool broken = false;
+
+        std::vector<Reservation>::iterator it = m_reservations.begin();
+
+        while (it != m_reservations.end()) {
+            if ((it->granule >= first) && (it->granule <= last)) {
+                it = m_reservations.erase(it);
+                broken = true;
+            } else {
+                ++it;
+            }
+        }
+
+        return broken;
+    }
+
+    /**
+     * @brief Drop the reservation of an initiator, if any.
+     */
+    void clear(const void *initiator)
+    {
+        const int i = find(initiator);
+
+        if (i >= 0) {
+            m_reservations.erase(m_reservations.begin() + i);
+        }
+    }
+
+    /**
+     * @brief Return true if a granule in the given range is reserved.
+     */
+    bool is_reserved(uint64_t addr, uint64_t len) const
+    {
+        const uint64_t first = addr & m_mask;
+        const uint64_t last = (addr + len - 1) & m_mask;
+
+        for (const Reservation &r : m_reservations) {
+            if ((r.granule >= first) && (r.granule <= last)) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    /**
+     * @brief Narrow a range around an address to exclude the reserved granules.
+     *
+     * @param[in] addr An address inside the range.
+     * @param[in,out] start Start of the range.
+     * @param[in,out] end End (inclusive) of the range.
+     *
+     * @return false if addr itself lies in a reserved granule.
+     */
+    bool clamp(uint64_t addr, uint64_t &start, uint64_t &end) const
+    {
+        const uint64_t granule = addr & m_mask;
+
+        for (const Reservation &r : m_reservations) {
+            if (r.granule == granule) {
+                return false;
+            }
+
+            if ((r.granule < granule) && (r.granule + ~m_mask >= start)) {
+                start = r.granule + ~m_mask + 1;
+            } else if ((r.granule > granule) && (r.granule <= end)) {
+                end = r.granule - 1;
+            }
+        }
+
+        return true;
+    }
+
+    bool empty() const { return m_reservations.empty(); }
+    size_t size() const { return m_reservations.size(); }
+};
+
+#endif
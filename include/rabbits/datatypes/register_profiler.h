@@ -0,0 +1,129 @@
+/*
+ *  This file is part of Rabbits
+ *  Copyright (C) 2017  Clement Deschamps and Luc Michel
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/**
+ * @file register_profiler.h
+ * @brief RegisterProfiler class declaration
+ */
+
+#ifndef _RABBITS_DATATYPES_REGISTER_PROFILER_H
+#define _RABBITS_DATATYPES_REGISTER_PROFILER_H
+
+#include <cstdint>
+#include <vector>
+#include <ostream>
+
+/**
+ * @brief Access counters per target offset.
+ *
+ * Counters live in an open addressing hash table with linear probing, sized
+ * to a power of two and kept at most half full. A device has few hot
+ * registers, so the table stays small and a lookup usually hits the first
+ * probed slot.
+ */
+class RegisterProfiler {
+public:
+    struct Entry {
+        uint64_t offset;
+        uint64_t reads;
+        uint64_t writes;
+
+        uint64_t accesses() const { return reads + writes; }
+    };
+
+private:
+    static const uint64_t EMPTY = ~uint64_t(0);
+    static const size_t INITIAL_SIZE = 64;
+
+    std::vector<Entry> m_table;
+    size_t m_used = 0;
+
+    static size_t hash(uint64_t offset)
+    {
+        /* Fibonacci hashing, the high bits are the best mixed ones */
+        return (offset * 0x9e3779b97f4a7c15ull) >> 32;
+    }
+
+    Entry & slot(uint64_t offset)
+    {
+        const size_t mask = m_table.size() - 1;
+        size_t i = hash(offset) & mask;
+
+        while ((m_table[i].offset != offset) && (m_table[i].offset != EMPTY)) {
+            i = (i + 1) & mask;
+        }
+
+        return m_table[i];
+    }
+
+    void grow();
+
+public:
+    RegisterProfiler() { reset(); }
+
+    /**
+     * @brief Count an access.
+     *
+     * @param[in] offset Offset of the access in the target.
+     * @param[in] is_write true for a write access.
+     */
+    void record(uint64_t offset, bool is_write)
+    {
+        Entry &e = slot(offset);
+
+        if (e.offset == EMPTY) {
+            if (2 * (m_used + 1) > m_table.size()) {
+                grow();
+                record(offset, is_write);
+                return;
+            }
+
+            e.offset = offset;
+            m_used++;
+        }
+
+        if (is_write) {
+            e.writes++;
+        } else {
+            e.reads++;
+        }
+    }
+
+    /**
+     * @brief Return the most accessed offsets, most accessed first.
+     *
+     * @param[in] n Maximum number of entries to return.
+     * @param[out] out The entries.
+     */
+    void top(size_t n, std::vector<Entry> &out) const;
+
+    /**
+     * @brief Print the n most accessed offsets with their read/write ratio.
+     */
+    void dump(std::ostream &o, size_t n) const;
+
+    void reset();
+
+    /**
+     * @brief Return the number of distinct offsets accessed.
+     */
+    size_t size() const { return m_used; }
+};
+
+#endif
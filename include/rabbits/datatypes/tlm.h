@@ -50,9 +50,71 @@ public:
                                    N> initiator;
 };
 
+/**
+ * @brief A target mapped in a bus address space.
+ */
+struct MemoryMapping {
+    AddressRange range;         /**< Range of the target in the bus address space */
+    sc_core::sc_object *target; /**< Module owning the target socket, nullptr if unknown */
+};
+
+/**
+ * @brief View over the targets mapped on a bus, sorted by address.
+ *
+ * The view does not copy the mapping. It remains valid as long as no target
+ * is connected to the bus, i.e. once the elaboration is over.
+ */
+class MemoryMappingView {
+public:
+    typedef const MemoryMapping * const_iterator;
+
+private:
+    const_iterator m_begin;
+    const_iterator m_end;
+
+public:
+    MemoryMappingView() : m_begin(nullptr), m_end(nullptr) {}
+    MemoryMappingView(const_iterator begin, const_iterator end)
+        : m_begin(begin), m_end(end) {}
+
+    const_iterator begin() const { return m_begin; }
+    const_iterator end() const { return m_end; }
+
+    size_t size() const { return m_end - m_begin; }
+    bool empty() const { return m_begin == m_end; }
+};
+
 class MemoryMappingInspectorScIface : public virtual sc_core::sc_interface {
 public:
     virtual const std::vector<AddressRange> & get_memory_mapping() const = 0;
+
+    /**
+     * @brief Find the target mapped at an address.
+     *
+     * The default implementation has no knowledge of the targets and always
+     * fails.
+     *
+     * @param[in] addr The address to look for.
+     * @param[out] mapping The mapping containing the address.
+     * @param[out] offset The offset of the address in the target.
+     *
+     * @return false if the address is not mapped.
+     */
+    virtual bool lookup_target(uint64_t addr, MemoryMapping &mapping,
+                               uint64_t &offset) const
+    {
+        return false;
+    }
+
+    /**
+     * @brief Return a view over the mapped targets, sorted by address.
+     *
+     * The default implementation returns an empty view.
+     */
+    virtual MemoryMappingView get_memory_mapping_view() const
+    {
+        return MemoryMappingView();
+    }
 };
 
 template <unsigned int BUSWIDTH = 32>
@@ -120,4 +182,27 @@ public:
     bool is_error() const { return m_val != OK; }
 };
 
+/**
+ * @brief One element of a vectored bus access.
+ *
+ * The status is filled by the initiator port once the element has been
+ * processed.
+ */
+struct BusAccessDescriptor
+{
+    uint64_t addr;
+    uint8_t *data;
+    unsigned int len;
+
+    BusAccessResponseStatus status;
+
+    BusAccessDescriptor()
+        : addr(0), data(nullptr), len(0)
+        , status(BusAccessResponseStatus::INCOMPLETE) {}
+
+    BusAccessDescriptor(uint64_t addr, uint8_t *data, unsigned int len)
+        : addr(addr), data(data), len(len)
+        , status(BusAccessResponseStatus::INCOMPLETE) {}
+};
+
 #endif
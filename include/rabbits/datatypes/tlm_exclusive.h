@@ -0,0 +1,73 @@
+/*
+ *  This file is part of Rabbits
+ *  Copyright (C) 2017  Clement Deschamps and Luc Michel
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/**
+ * @file tlm_exclusive.h
+ * @brief TlmExclusiveExtension class declaration
+ */
+
+#ifndef _RABBITS_DATATYPES_TLM_EXCLUSIVE_H
+#define _RABBITS_DATATYPES_TLM_EXCLUSIVE_H
+
+#include <tlm>
+
+/**
+ * @brief TLM extension marking an exclusive access.
+ *
+ * An exclusive read (load-linked) asks the target to set a reservation on
+ * the accessed address for the initiator. An exclusive write
+ * (store-conditional) is performed only if the reservation of the initiator
+ * still holds. The target reports the outcome with set_ok(). A target that
+ * does not support exclusive accesses leaves the extension untouched, so the
+ * access is seen as failed by the initiator.
+ */
+class TlmExclusiveExtension : public tlm::tlm_extension<TlmExclusiveExtension> {
+private:
+    const void *m_initiator = nullptr;
+    bool m_ok = false;
+
+public:
+    TlmExclusiveExtension() {}
+    explicit TlmExclusiveExtension(const void *initiator) : m_initiator(initiator) {}
+
+    /**
+     * @brief Return the opaque identifier of the initiator owning the access.
+     */
+    const void * get_initiator() const { return m_initiator; }
+    void set_initiator(const void *initiator) { m_initiator = initiator; }
+
+    /**
+     * @brief Return true if the target honoured the exclusive access.
+     */
+    bool is_ok() const { return m_ok; }
+    void set_ok(bool ok) { m_ok = ok; }
+
+    /* tlm::tlm_extension */
+    tlm::tlm_extension_base * clone() const
+    {
+        return new TlmExclusiveExtension(*this);
+    }
+
+    void copy_from(const tlm::tlm_extension_base &ext)
+    {
+        *this = static_cast<const TlmExclusiveExtension&>(ext);
+    }
+};
+
+#endif
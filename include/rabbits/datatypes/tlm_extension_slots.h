@@ -0,0 +1,119 @@
+/*
+ *  This file is part of Rabbits
+ *  Copyright (C) 2017  Clement Deschamps and Luc Michel
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/**
+ * @file tlm_extension_slots.h
+ * @brief TlmExtensionSlots class declaration
+ */
+
+#ifndef _RABBITS_DATATYPES_TLM_EXTENSION_SLOTS_H
+#define _RABBITS_DATATYPES_TLM_EXTENSION_SLOTS_H
+
+#include <vector>
+
+#include <tlm>
+
+/**
+ * @brief Preallocated TLM extensions attached to every access of an initiator.
+ *
+ * Each extension type gets one slot, holding an extension object allocated
+ * the first time the slot is requested and owned by the registry. The
+ * initiator fills the objects in place, and the same objects are attached to
+ * each payload it sends and detached once the transaction is done, so tagging
+ * accesses with metadata does not involve any heap allocation.
+ *
+ * Slots are indexed with the TLM extension ID, so a target reads them back
+ * with tlm_generic_payload::get_extension(), without any dynamic_cast.
+ */
+class TlmExtensionSlots {
+private:
+    std::vector<tlm::tlm_extension_base*> m_slots;
+    std::vector<unsigned int> m_used;
+
+public:
+    TlmExtensionSlots() {}
+    TlmExtensionSlots(const TlmExtensionSlots&) = delete;
+    TlmExtensionSlots & operator= (const TlmExtensionSlots&) = delete;
+
+    virtual ~TlmExtensionSlots()
+    {
+        for (unsigned int id : m_used) {
+            m_slots[id]->free();
+        }
+    }
+
+    /**
+     * @brief Return the extension object of the given type.
+     *
+     * The object is allocated on the first call, and attached to all the
+     * subsequent accesses.
+     *
+     * @tparam EXT The extension type, a tlm::tlm_extension<EXT>.
+     */
+    template <class EXT>
+    EXT & get()
+    {
+        const unsigned int id = EXT::ID;
+
+        if (id >= m_slots.size()) {
+            m_slots.resize(id + 1, nullptr);
+        }
+
+        if (m_slots[id] == nullptr) {
+            m_slots[id] = new EXT;
+            m_used.push_back(id);
+        }
+
+        return *static_cast<EXT*>(m_slots[id]);
+    }
+
+    /**
+     * @brief Return true if a slot has been allocated for the given type.
+     */
+    template <class EXT>
+    bool has() const
+    {
+        return (EXT::ID < m_slots.size()) && (m_slots[EXT::ID] != nullptr);
+    }
+
+    /**
+     * @brief Attach all the allocated extensions to a payload.
+     */
+    void attach(tlm::tlm_generic_payload &trans) const
+    {
+        for (unsigned int id : m_used) {
+            trans.set_extension(id, m_slots[id]);
+        }
+    }
+
+    /**
+     * @brief Detach the extensions set by attach() from a payload.
+     */
+    void detach(tlm::tlm_generic_payload &trans) const
+    {
+        for (unsigned int id : m_used) {
+            trans.set_extension(id, nullptr);
+        }
+    }
+
+    bool empty() const { return m_used.empty(); }
+    size_t size() const { return m_used.size(); }
+};
+
+#endif
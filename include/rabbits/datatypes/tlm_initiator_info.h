@@ -0,0 +1,82 @@
+/*
+ *  This file is part of Rabbits
+ *  Copyright (C) 2017  Clement Deschamps and Luc Michel
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/**
+ * @file tlm_initiator_info.h
+ * @brief TlmInitiatorInfo class declaration
+ */
+
+#ifndef _RABBITS_DATATYPES_TLM_INITIATOR_INFO_H
+#define _RABBITS_DATATYPES_TLM_INITIATOR_INFO_H
+
+#include <cstdint>
+
+#include <tlm>
+
+/**
+ * @brief TLM extension describing the initiator of an access.
+ *
+ * Carries the initiator ID, the privilege level the access is made at and
+ * the kind of access. It is meant to live in a TlmExtensionSlots registry, so
+ * that the initiator updates it in place before issuing its accesses.
+ */
+class TlmInitiatorInfo : public tlm::tlm_extension<TlmInitiatorInfo> {
+public:
+    enum AccessType {
+        DATA,
+        INSTRUCTION,
+        PAGE_TABLE_WALK,
+    };
+
+private:
+    uint32_t m_id = 0;
+    unsigned int m_privilege = 0;
+    AccessType m_type = DATA;
+
+public:
+    TlmInitiatorInfo() {}
+
+    uint32_t get_id() const { return m_id; }
+    void set_id(uint32_t id) { m_id = id; }
+
+    /**
+     * @brief Return the privilege level of the access.
+     *
+     * The meaning of the level is architecture dependent. Zero is the least
+     * privileged level.
+     */
+    unsigned int get_privilege() const { return m_privilege; }
+    void set_privilege(unsigned int privilege) { m_privilege = privilege; }
+
+    AccessType get_type() const { return m_type; }
+    void set_type(AccessType type) { m_type = type; }
+
+    /* tlm::tlm_extension */
+    tlm::tlm_extension_base * clone() const
+    {
+        return new TlmInitiatorInfo(*this);
+    }
+
+    void copy_from(const tlm::tlm_extension_base &ext)
+    {
+        *this = static_cast<const TlmInitiatorInfo&>(ext);
+    }
+};
+
+#endif
@@ -0,0 +1,115 @@
+/*
+ *  This file is part of Rabbits
+ *  Copyright (C) 2017  Clement Deschamps and Luc Michel
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/**
+ * @file tlm_payload_pool.h
+ * @brief TlmPayloadPool class declaration
+ */
+
+#ifndef _RABBITS_DATATYPES_TLM_PAYLOAD_POOL_H
+#define _RABBITS_DATATYPES_TLM_PAYLOAD_POOL_H
+
+#include <vector>
+
+#include <systemc>
+#include <tlm>
+
+/**
+ * @brief Pool of reusable TLM generic payloads.
+ *
+ * Payloads handed out by the pool have it set as their TLM memory manager.
+ * When their reference count drops to zero, they are reset and go back to the
+ * pool instead of being destroyed. Once the pool has grown to the maximum
+ * number of simultaneously used payloads, acquiring and releasing a payload
+ * does not involve any heap allocation.
+ *
+ * Extensions that are not auto extensions are not freed by the reset. They
+ * must be cleared by their owner before the payload is released.
+ */
+class TlmPayloadPool : public tlm::tlm_mm_interface {
+private:
+    std::vector<tlm::tlm_generic_payload*> m_all;
+    std::vector<tlm::tlm_generic_payload*> m_free;
+
+public:
+    TlmPayloadPool() {}
+
+    virtual ~TlmPayloadPool()
+    {
+        for (tlm::tlm_generic_payload *trans : m_all) {
+            delete trans;
+        }
+    }
+
+    /**
+     * @brief Get a payload from the pool.
+     *
+     * The returned payload has a reference count of one.
+     *
+     * @return a payload ready to be filled.
+     */
+    tlm::tlm_generic_payload * acquire()
+    {
+        tlm::tlm_generic_payload *trans;
+
+        if (m_free.empty()) {
+            trans = new tlm::tlm_generic_payload(this);
+            m_all.push_back(trans);
+            m_free.reserve(m_all.size());
+        } else {
+            trans = m_free.back();
+            m_free.pop_back();
+        }
+
+        trans->acquire();
+        return trans;
+    }
+
+    /**
+     * @brief Drop the reference taken by acquire().
+     *
+     * The payload goes back to the pool as soon as no one else holds a
+     * reference on it.
+     *
+     * @param[in] trans The payload to release.
+     */
+    void release(tlm::tlm_generic_payload *trans)
+    {
+        trans->release();
+    }
+
+    /**
+     * @brief Return the number of payloads allocated by the pool.
+     */
+    size_t size() const { return m_all.size(); }
+
+    /**
+     * @brief Return the number of payloads currently available in the pool.
+     */
+    size_t available() const { return m_free.size(); }
+
+    /* tlm::tlm_mm_interface */
+    void free(tlm::tlm_generic_payload *trans)
+    {
+        trans->reset();
+        m_free.push_back(trans);
+    }
+};
+
+#endif
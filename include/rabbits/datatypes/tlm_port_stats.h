@@ -0,0 +1,108 @@
+/*
+ *  This file is part of Rabbits
+ *  Copyright (C) 2017  Clement Deschamps and Luc Michel
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/**
+ * @file tlm_port_stats.h
+ * @brief TlmPortStats class declaration
+ */
+
+#ifndef _RABBITS_DATATYPES_TLM_PORT_STATS_H
+#define _RABBITS_DATATYPES_TLM_PORT_STATS_H
+
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+
+#include <systemc>
+
+/**
+ * @brief Transaction counters of a TLM port.
+ *
+ * Updating the counters costs a few increments per transaction, so they are
+ * always maintained. Latencies are the delays annotated during the
+ * transactions. They are accumulated in a histogram with power of two
+ * buckets: bucket 0 counts zero latencies, and bucket i counts latencies in
+ * [2^(i-1), 2^i) time resolution units.
+ */
+class TlmPortStats {
+public:
+    static const int LATENCY_BUCKETS = 65;
+
+    uint64_t reads;
+    uint64_t writes;
+    uint64_t read_bytes;
+    uint64_t write_bytes;
+    uint64_t errors;
+
+    uint64_t socket_accesses; /**< Transactions that went through the socket */
+    uint64_t dmi_accesses;    /**< Accesses served through a DMI pointer */
+    uint64_t dmi_grants;      /**< DMI regions granted */
+    uint64_t combined_writes; /**< Writes merged in a write combining buffer */
+
+    uint64_t latencies[LATENCY_BUCKETS];
+
+    TlmPortStats() { reset(); }
+
+    void reset()
+    {
+        std::memset(this, 0, sizeof(*this));
+    }
+
+    static int latency_bucket(const sc_core::sc_time &latency)
+    {
+        const uint64_t v = latency.value();
+        return v ? (64 - __builtin_clzll(v)) : 0;
+    }
+
+    /**
+     * @brief Record a transaction.
+     *
+     * @param[in] is_write true for a write transaction.
+     * @param[in] len Length of the transaction, in bytes.
+     * @param[in] error true if the transaction failed.
+     * @param[in] dmi true if the transaction was served through DMI.
+     * @param[in] latency The annotated latency of the transaction.
+     */
+    void record(bool is_write, unsigned int len, bool error, bool dmi,
+                const sc_core::sc_time &latency)
+    {
+        if (is_write) {
+            writes++;
+            write_bytes += len;
+        } else {
+            reads++;
+            read_bytes += len;
+        }
+
+        errors += error;
+        dmi_accesses += dmi;
+        socket_accesses += !dmi;
+
+        latencies[latency_bucket(latency)]++;
+    }
+
+    uint64_t accesses() const { return reads + writes; }
+
+    /**
+     * @brief Write a human readable report of the counters.
+     */
+    void dump(std::ostream &o) const;
+};
+
+#endif
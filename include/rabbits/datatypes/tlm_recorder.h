@@ -0,0 +1,124 @@
+/*
+ *  This file is part of Rabbits
+ *  Copyright (C) 2017  Clement Deschamps and Luc Michel
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/**
+ * @file tlm_recorder.h
+ * @brief TlmRecorder and TlmTraceReader classes declaration
+ */
+
+#ifndef _RABBITS_DATATYPES_TLM_RECORDER_H
+#define _RABBITS_DATATYPES_TLM_RECORDER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <fstream>
+
+#include <systemc>
+#include <tlm>
+
+/**
+ * @brief A transaction read back from a recording.
+ */
+struct TlmTraceRecord {
+    uint64_t time;   /**< Time of the transaction, in time resolution units */
+    uint64_t addr;
+    uint32_t len;
+    uint8_t cmd;     /**< A tlm::tlm_command */
+    uint8_t status;  /**< 1 if the transaction succeeded, 0 otherwise */
+};
+
+/**
+ * @brief Recorder of the transactions received by a target.
+ *
+ * The recording is a compact binary stream: a header made of the
+ * RECORD_MAGIC string and a 32-bit version, followed by one record per
+ * transaction. A record is the fields of TlmTraceRecord, packed in this
+ * order, followed by the transaction data (the data written, or the data
+ * returned for a read). Integers are stored in host byte order.
+ *
+ * Byte enables and streaming width are not recorded.
+ */
+class TlmRecorder {
+public:
+    static const char RECORD_MAGIC[8];
+    static const uint32_t RECORD_VERSION = 1;
+
+private:
+    std::ofstream m_out;
+    uint64_t m_count = 0;
+
+public:
+    TlmRecorder() {}
+    virtual ~TlmRecorder();
+
+    /**
+     * @brief Open the recording file and write its header.
+     *
+     * @return false if the file cannot be created.
+     */
+    bool open(const std::string &filename);
+    void close();
+
+    bool is_open() const { return m_out.is_open(); }
+
+    /**
+     * @brief Append a completed transaction to the recording.
+     *
+     * @param[in] trans The transaction.
+     * @param[in] time The time at which the transaction took place.
+     */
+    void record(const tlm::tlm_generic_payload &trans, const sc_core::sc_time &time);
+
+    /**
+     * @brief Return the number of recorded transactions.
+     */
+    uint64_t get_count() const { return m_count; }
+};
+
+/**
+ * @brief Reader of a recording made by a TlmRecorder.
+ */
+class TlmTraceReader {
+private:
+    std::ifstream m_in;
+
+public:
+    TlmTraceReader() {}
+    virtual ~TlmTraceReader() {}
+
+    /**
+     * @brief Open a recording and check its header.
+     *
+     * @return false if the file cannot be read or is not a recording.
+     */
+    bool open(const std::string &filename);
+
+    /**
+     * @brief Read the next transaction of the recording.
+     *
+     * @param[out] rec The transaction.
+     * @param[out] data The transaction data, resized to its length.
+     *
+     * @return false at the end of the recording.
+     */
+    bool next(TlmTraceRecord &rec, std::vector<uint8_t> &data);
+};
+
+#endif
@@ -68,6 +68,10 @@ public:
         Master::bus_write(addr, reinterpret_cast<uint8_t*>(&data), sizeof(data));
     }
 
+    void bus_write_u64(uint64_t addr, uint64_t data) {
+        Master::bus_write(addr, reinterpret_cast<uint8_t*>(&data), sizeof(data));
+    }
+
     uint8_t bus_read_u8(uint64_t addr) {
         uint8_t data;
         Master::bus_read(addr, &data, sizeof(data));
@@ -86,6 +90,12 @@ public:
         return data;
     }
 
+    uint64_t bus_read_u64(uint64_t addr) {
+        uint64_t data;
+        Master::bus_read(addr, reinterpret_cast<uint8_t*>(&data), sizeof(data));
+        return data;
+    }
+
     void debug_access_nofail(tlm::tlm_command cmd, uint64_t addr,
                              uint8_t *data, unsigned int len) {
         unsigned int ret;
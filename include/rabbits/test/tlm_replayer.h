@@ -0,0 +1,104 @@
+/*
+ *  This file is part of Rabbits
+ *  Copyright (C) 2017  Clement Deschamps and Luc Michel
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/**
+ * @file tlm_replayer.h
+ * @brief TlmReplayer class declaration
+ */
+
+#ifndef _RABBITS_TEST_TLM_REPLAYER_H
+#define _RABBITS_TEST_TLM_REPLAYER_H
+
+#include <cstring>
+#include <vector>
+
+#include "rabbits/test/slave_tester.h"
+#include "rabbits/datatypes/tlm_recorder.h"
+
+/**
+ * @brief Replay driver for transaction recordings.
+ *
+ * Feeds a recording made by a TlmTargetPort (see the `tlm-record' global
+ * parameter) into the component it is connected to. Transactions are
+ * replayed back to back, at full speed, regardless of their recorded time.
+ * This allows benchmarking a single component with a real workload.
+ */
+template <unsigned int BUSWIDTH = 32>
+class TlmReplayer : public SlaveTester<BUSWIDTH> {
+protected:
+    uint64_t m_mismatches = 0;
+
+public:
+    TlmReplayer(sc_core::sc_module_name n, ConfigManager &c) : SlaveTester<BUSWIDTH>(n, c) {}
+
+    virtual ~TlmReplayer() {}
+
+    /**
+     * @brief Replay a recording.
+     *
+     * Must be called from a SystemC thread.
+     *
+     * @param[in] filename The recording file.
+     * @param[in] check If true, compare the data returned by reads and the
+     *                  status of each transaction with the recorded ones.
+     *
+     * @return the number of replayed transactions.
+     */
+    uint64_t replay(const std::string &filename, bool check = false)
+    {
+        TlmTraceReader reader;
+        TlmTraceRecord rec;
+        std::vector<uint8_t> data, buf;
+        uint64_t count = 0;
+
+        if (!reader.open(filename)) {
+            throw TestFailureException("Unable to read recording " + filename);
+        }
+
+        while (reader.next(rec, data)) {
+            if (rec.cmd == tlm::TLM_READ_COMMAND) {
+                buf.resize(rec.len);
+                this->p_bus.bus_read(rec.addr, buf.data(), rec.len);
+
+                if (check && rec.status && std::memcmp(buf.data(), data.data(), rec.len)) {
+                    m_mismatches++;
+                }
+            } else if (rec.cmd == tlm::TLM_WRITE_COMMAND) {
+                this->p_bus.bus_write(rec.addr, data.data(), rec.len);
+            } else {
+                continue;
+            }
+
+            if (check && (this->last_access_succeeded() != bool(rec.status))) {
+                m_mismatches++;
+            }
+
+            count++;
+        }
+
+        return count;
+    }
+
+    /**
+     * @brief Return the number of mismatches found by checked replays.
+     */
+    uint64_t get_mismatches() const { return m_mismatches; }
+};
+
+#endif
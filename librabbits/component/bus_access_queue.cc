@@ -0,0 +1,139 @@
+/*
+ *  This file is part of Rabbits
+ *  Copyright (C) 2017  Clement Deschamps and Luc Michel
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <memory>
+
+#include "rabbits-common.h"
+#include "rabbits/component/bus_access_queue.h"
+
+using std::vector;
+using std::future;
+using std::promise;
+using std::shared_ptr;
+
+BusAccessQueue::BusAccessQueue(DebugInitiator &initiator)
+    : sc_core::sc_prim_channel(sc_core::sc_gen_unique_name("bus_access_queue"))
+    , m_initiator(initiator)
+{}
+
+BusAccessQueue::BusAccessQueue(const char *name, DebugInitiator &initiator)
+    : sc_core::sc_prim_channel(name)
+    , m_initiator(initiator)
+{}
+
+BusAccessQueue::~BusAccessQueue()
+{}
+
+void BusAccessQueue::post(Request &r)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pending.push_back(std::move(r));
+    }
+
+    async_request_update();
+}
+
+void BusAccessQueue::process(Request &r)
+{
+    uint64_t ret;
+
+    if (r.cmd == tlm::TLM_READ_COMMAND) {
+        r.data.resize(r.size);
+        ret = m_initiator.debug_read(r.addr, r.data.data(), r.size);
+        r.data.resize(ret);
+
+        if (r.read_cb) {
+            r.read_cb(r.data);
+        }
+    } else {
+        ret = m_initiator.debug_write(r.addr, r.data.data(), r.size);
+
+        if (r.write_cb) {
+            r.write_cb(ret);
+        }
+    }
+}
+
+void BusAccessQueue::update()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_draining.swap(m_pending);
+    }
+
+    for (Request &r : m_draining) {
+        process(r);
+    }
+
+    m_draining.clear();
+}
+
+void BusAccessQueue::post_read(uint64_t addr, uint64_t size, ReadCallback cb)
+{
+    Request r;
+
+    r.cmd = tlm::TLM_READ_COMMAND;
+    r.addr = addr;
+    r.size = size;
+    r.read_cb = cb;
+
+    post(r);
+}
+
+void BusAccessQueue::post_write(uint64_t addr, const void *buf, uint64_t size,
+                                WriteCallback cb)
+{
+    Request r;
+    const uint8_t *p = static_cast<const uint8_t*>(buf);
+
+    r.cmd = tlm::TLM_WRITE_COMMAND;
+    r.addr = addr;
+    r.size = size;
+    r.data.assign(p, p + size);
+    r.write_cb = cb;
+
+    post(r);
+}
+
+future< vector<uint8_t> > BusAccessQueue::read(uint64_t addr, uint64_t size)
+{
+    shared_ptr< promise< vector<uint8_t> > > p(new promise< vector<uint8_t> >);
+    future< vector<uint8_t> > f = p->get_future();
+
+    post_read(addr, size, [p] (const vector<uint8_t> &data) { p->set_value(data); });
+
+    return f;
+}
+
+future<uint64_t> BusAccessQueue::write(uint64_t addr, const void *buf, uint64_t size)
+{
+    shared_ptr< promise<uint64_t> > p(new promise<uint64_t>);
+    future<uint64_t> f = p->get_future();
+
+    post_write(addr, buf, size, [p] (uint64_t written) { p->set_value(written); });
+
+    return f;
+}
+
+size_t BusAccessQueue::pending()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_pending.size();
+}
@@ -17,6 +17,9 @@
  *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
  */
 
+#include <algorithm>
+#include <cstring>
+
 #include "rabbits-common.h"
 #include "rabbits/component/debug_initiator.h"
 
@@ -34,14 +37,60 @@ DebugInitiator::~DebugInitiator()
 {}
 
 
+/* Largest request sent through debug transport at once */
+static const uint64_t DEBUG_CHUNK_SIZE = 1 << 20;
+
+uint64_t DebugInitiator::debug_access(tlm::tlm_command cmd, uint64_t addr,
+                                      uint8_t *buf, uint64_t size)
+{
+    const bool write = (cmd == tlm::TLM_WRITE_COMMAND);
+    uint64_t done = 0;
+
+    while (done < size) {
+        const uint64_t cur = addr + done;
+        const uint64_t left = size - done;
+        uint64_t len;
+        DmiInfo dmi;
+
+        if (p_bus.dmi_probe(AddressRange(cur, left), dmi, cmd)
+            && (write ? dmi.write_allowed : dmi.read_allowed)
+            && (cur >= dmi.range.begin()) && (cur <= dmi.range.end())) {
+            const uint64_t avail = dmi.range.end() - cur;
+            uint8_t *p = static_cast<uint8_t*>(dmi.ptr) + (cur - dmi.range.begin());
+
+            len = (left - 1 <= avail) ? left : avail + 1;
+
+            if (write) {
+                std::memcpy(p, buf + done, len);
+            } else {
+                std::memcpy(buf + done, p, len);
+            }
+        } else {
+            len = std::min(left, DEBUG_CHUNK_SIZE);
+
+            const uint64_t ret = write
+                ? p_bus.debug_write(cur, buf + done, len)
+                : p_bus.debug_read(cur, buf + done, len);
+
+            if (ret < len) {
+                return done + ret;
+            }
+        }
+
+        done += len;
+    }
+
+    return done;
+}
+
 uint64_t DebugInitiator::debug_read(uint64_t addr, void *buf, uint64_t size)
 {
-    return static_cast<uint64_t>(
-        p_bus.debug_read(addr, reinterpret_cast<uint8_t*>(buf), size));
+    return debug_access(tlm::TLM_READ_COMMAND, addr,
+                        reinterpret_cast<uint8_t*>(buf), size);
 }
 
 uint64_t DebugInitiator::debug_write(uint64_t addr, const void *buf, uint64_t size)
 {
-    return static_cast<uint64_t>(
-        p_bus.debug_write(addr, reinterpret_cast<const uint8_t*>(buf), size));
+    return debug_access(tlm::TLM_WRITE_COMMAND, addr,
+                        const_cast<uint8_t*>(reinterpret_cast<const uint8_t*>(buf)), size);
 }
@@ -51,6 +51,33 @@ void Port::add_attr_to_parent(const std::string & key, const std::string & value
     }
 }
 
+bool Port::get_global_flag(const std::string & key) const
+{
+    if (!m_parent) {
+        return false;
+    }
+
+    return m_parent->get_component().get_config().get_global_params()[key].as<bool>();
+}
+
+std::string Port::get_global_string(const std::string & key) const
+{
+    if (!m_parent) {
+        return "";
+    }
+
+    return m_parent->get_component().get_config().get_global_params()[key].as<std::string>();
+}
+
+uint32_t Port::get_global_uint(const std::string & key) const
+{
+    if (!m_parent) {
+        return 0;
+    }
+
+    return m_parent->get_component().get_config().get_global_params()[key].as<uint32_t>();
+}
+
 
 std::string Port::full_name()
 {
@@ -80,6 +80,36 @@ void ConfigManager::add_global_params()
                                      true,
                                      true));
 
+    add_global_param("quantum",
+                     Parameter<sc_core::sc_time>("Global quantum for initiators "
+                                                 "temporal decoupling (zero disables it)",
+                                                 sc_core::SC_ZERO_TIME,
+                                                 true));
+
+    add_global_param("tlm-stats",
+                     Parameter<bool>("Dump the transaction statistics of the TLM "
+                                     "ports at the end of the simulation",
+                                     false));
+
+    add_global_param("tlm-record",
+                     Parameter<string>("Directory where to record the transactions "
+                                       "received by the TLM target ports "
+                                       "(disabled if empty)",
+                                       ""));
+
+    add_global_param("register-profile",
+                     Parameter<uint32_t>("Number of most accessed registers to report "
+                                         "for each TLM target at the end of the "
+                                         "simulation (0 disables the profiling)",
+                                         0));
+
+    add_global_param("write-combining",
+                     Parameter<bool>("Merge adjacent small writes of the initiators "
+                                     "to the targets flagged `write-combinable' "
+                                     "into larger transactions",
+                                     false,
+                                     true));
+
     add_global_param("log-target",
                      Parameter<string>("Specify the log target (valid options "
                                        "are `stdout', `stderr' and `file')",
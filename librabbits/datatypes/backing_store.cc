@@ -0,0 +1,85 @@
+/*
+ *  This file is part of Rabbits
+ *  Copyright (C) 2017  Clement Deschamps and Luc Michel
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <cstdlib>
+#include <sstream>
+
+#include "rabbits/config.h"
+#include "rabbits/datatypes/backing_store.h"
+#include "rabbits/rabbits_exception.h"
+
+#ifdef RABBITS_CONFIG_POSIX
+# include <sys/mman.h>
+#endif
+
+static void allocation_failure(uint64_t size)
+{
+    std::stringstream ss;
+    ss << "Unable to allocate a " << size << " bytes backing store";
+    throw RabbitsException(ss.str());
+}
+
+#ifdef RABBITS_CONFIG_POSIX
+
+BackingStore::BackingStore(uint64_t size)
+    : m_size(size)
+{
+    if (!size) {
+        return;
+    }
+
+    void *p = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+
+    if (p == MAP_FAILED) {
+        allocation_failure(size);
+    }
+
+    m_data = static_cast<uint8_t*>(p);
+}
+
+BackingStore::~BackingStore()
+{
+    if (m_data) {
+        munmap(m_data, m_size);
+    }
+}
+
+#else
+
+BackingStore::BackingStore(uint64_t size)
+    : m_size(size)
+{
+    if (!size) {
+        return;
+    }
+
+    m_data = static_cast<uint8_t*>(std::calloc(size, 1));
+
+    if (m_data == NULL) {
+        allocation_failure(size);
+    }
+}
+
+BackingStore::~BackingStore()
+{
+    std::free(m_data);
+}
+
+#endif
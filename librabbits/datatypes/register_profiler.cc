@@ -0,0 +1,84 @@
+/*
+ *  This file is part of Rabbits
+ *  Copyright (C) 2017  Clement Deschamps and Luc Michel
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <algorithm>
+#include <iomanip>
+
+#include "rabbits/datatypes/register_profiler.h"
+
+const uint64_t RegisterProfiler::EMPTY;
+const size_t RegisterProfiler::INITIAL_SIZE;
+
+static bool more_accessed(const RegisterProfiler::Entry &a,
+                          const RegisterProfiler::Entry &b)
+{
+    return a.accesses() > b.accesses();
+}
+
+void RegisterProfiler::grow()
+{
+    std::vector<Entry> old;
+
+    old.swap(m_table);
+    m_table.resize(2 * old.size(), Entry { EMPTY, 0, 0 });
+
+    for (const Entry &e : old) {
+        if (e.offset != EMPTY) {
+            slot(e.offset) = e;
+        }
+    }
+}
+
+void RegisterProfiler::reset()
+{
+    m_table.assign(INITIAL_SIZE, Entry { EMPTY, 0, 0 });
+    m_used = 0;
+}
+
+void RegisterProfiler::top(size_t n, std::vector<Entry> &out) const
+{
+    out.clear();
+
+    for (const Entry &e : m_table) {
+        if (e.offset != EMPTY) {
+            out.push_back(e);
+        }
+    }
+
+    n = std::min(n, out.size());
+    std::partial_sort(out.begin(), out.begin() + n, out.end(), more_accessed);
+    out.resize(n);
+}
+
+void RegisterProfiler::dump(std::ostream &o, size_t n) const
+{
+    std::vector<Entry> entries;
+
+    top(n, entries);
+
+    for (const Entry &e : entries) {
+        const double ratio = 100.0 * e.reads / e.accesses();
+
+        o << "  0x" << std::hex << std::setfill('0') << std::setw(8) << e.offset
+          << std::dec << std::setfill(' ')
+          << ": " << e.accesses() << " accesses, "
+          << std::fixed << std::setprecision(1)
+          << ratio << "% reads / " << (100.0 - ratio) << "% writes\n";
+    }
+}
@@ -0,0 +1,52 @@
+/*
+ *  This file is part of Rabbits
+ *  Copyright (C) 2017  Clement Deschamps and Luc Michel
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "rabbits/datatypes/tlm_port_stats.h"
+
+void TlmPortStats::dump(std::ostream &o) const
+{
+    const sc_core::sc_time res = sc_core::sc_get_time_resolution();
+
+    o << "reads: " << reads << " (" << read_bytes << " bytes), "
+      << "writes: " << writes << " (" << write_bytes << " bytes), "
+      << "errors: " << errors << "\n";
+
+    o << "socket accesses: " << socket_accesses << ", "
+      << "dmi accesses: " << dmi_accesses << ", "
+      << "dmi grants: " << dmi_grants << "\n";
+
+    if (combined_writes) {
+        o << "combined writes: " << combined_writes << "\n";
+    }
+
+    for (int i = 0; i < LATENCY_BUCKETS; i++) {
+        if (!latencies[i]) {
+            continue;
+        }
+
+        if (i == 0) {
+            o << "  latency 0";
+        } else {
+            const sc_core::sc_time lo = res * double(uint64_t(1) << (i - 1));
+            o << "  latency [" << lo << ", " << (lo * 2) << ")";
+        }
+
+        o << ": " << latencies[i] << "\n";
+    }
+}
@@ -0,0 +1,116 @@
+/*
+ *  This file is part of Rabbits
+ *  Copyright (C) 2017  Clement Deschamps and Luc Michel
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <cstring>
+
+#include "rabbits/datatypes/tlm_recorder.h"
+
+const char TlmRecorder::RECORD_MAGIC[8] = { 'R', 'B', 'T', 'L', 'M', 'R', 'E', 'C' };
+const uint32_t TlmRecorder::RECORD_VERSION;
+
+template <typename T>
+static inline void put(std::ofstream &o, const T &v)
+{
+    o.write(reinterpret_cast<const char*>(&v), sizeof(v));
+}
+
+template <typename T>
+static inline bool get(std::ifstream &i, T &v)
+{
+    return bool(i.read(reinterpret_cast<char*>(&v), sizeof(v)));
+}
+
+TlmRecorder::~TlmRecorder()
+{
+    close();
+}
+
+bool TlmRecorder::open(const std::string &filename)
+{
+    close();
+
+    m_out.open(filename.c_str(), std::ios::binary | std::ios::trunc);
+
+    if (!m_out) {
+        return false;
+    }
+
+    m_out.write(RECORD_MAGIC, sizeof(RECORD_MAGIC));
+    put(m_out, RECORD_VERSION);
+
+    m_count = 0;
+
+    return bool(m_out);
+}
+
+void TlmRecorder::close()
+{
+    if (m_out.is_open()) {
+        m_out.close();
+    }
+}
+
+void TlmRecorder::record(const tlm::tlm_generic_payload &trans, const sc_core::sc_time &time)
+{
+    const uint64_t t = time.value();
+    const uint64_t addr = trans.get_address();
+    const uint32_t len = trans.get_data_length();
+    const uint8_t cmd = trans.get_command();
+    const uint8_t status = trans.is_response_ok();
+
+    put(m_out, t);
+    put(m_out, addr);
+    put(m_out, len);
+    put(m_out, cmd);
+    put(m_out, status);
+    m_out.write(reinterpret_cast<const char*>(trans.get_data_ptr()), len);
+
+    m_count++;
+}
+
+bool TlmTraceReader::open(const std::string &filename)
+{
+    char magic[sizeof(TlmRecorder::RECORD_MAGIC)];
+    uint32_t version;
+
+    m_in.open(filename.c_str(), std::ios::binary);
+
+    if (!m_in) {
+        return false;
+    }
+
+    if (!m_in.read(magic, sizeof(magic))
+        || std::memcmp(magic, TlmRecorder::RECORD_MAGIC, sizeof(magic))) {
+        return false;
+    }
+
+    return get(m_in, version) && (version == TlmRecorder::RECORD_VERSION);
+}
+
+bool TlmTraceReader::next(TlmTraceRecord &rec, std::vector<uint8_t> &data)
+{
+    if (!(get(m_in, rec.time) && get(m_in, rec.addr) && get(m_in, rec.len)
+          && get(m_in, rec.cmd) && get(m_in, rec.status))) {
+        return false;
+    }
+
+    data.resize(rec.len);
+
+    return bool(m_in.read(reinterpret_cast<char*>(data.data()), rec.len));
+}
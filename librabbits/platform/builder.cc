@@ -21,6 +21,8 @@
 #include <set>
 #include <vector>
 
+#include <tlm_utils/tlm_quantumkeeper.h>
+
 #include "rabbits/platform/builder.h"
 
 #include "rabbits/logger.h"
@@ -47,6 +49,9 @@ PlatformBuilder::PlatformBuilder(sc_module_name name, PlatformDescription &descr
                                  ConfigManager &config)
     : sc_module(name), m_config(config), m_parser(string(name), descr, config)
 {
+    tlm_utils::tlm_quantumkeeper::set_global_quantum(
+        m_config.get_global_params()["quantum"].as<sc_time>());
+
     create_plugins(m_parser);
     run_hooks(PluginHookBeforeBuild(descr, *this, m_parser));
 
@@ -99,3 +99,27 @@ void BinaryLoaderHelper::load_data(const void *data, size_t len, DebugInitiator
 
     result.result = ImageLoadResult::LOAD_SUCCESS;
 }
+
+bool BinaryStreamLoader::write(const uint8_t *data, size_t len)
+{
+    uint64_t written;
+
+    written = m_di.debug_write(m_load_addr + m_pos, data, len);
+    m_pos += written;
+
+    if (written < len) {
+        LOG_F(APP, ERR, "Only %" PRIu64 " bytes were written over %" PRIu64
+              ". Trying to write outside ram?\n", m_pos, m_pos + (len - written));
+        return false;
+    }
+
+    return true;
+}
+
+void BinaryStreamLoader::finish(ImageLoadResult &result)
+{
+    result.has_entry_point = false;
+    result.has_load_size = true;
+    result.load_size = m_pos;
+    result.result = ImageLoadResult::LOAD_SUCCESS;
+}
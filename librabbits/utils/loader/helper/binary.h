@@ -21,6 +21,8 @@
 
 #include "rabbits/utils/loader/helper.h"
 
+#include "stream.h"
+
 class BinaryLoaderHelper : public ImageLoaderHelper {
 public:
     void load_file(const std::string &fn, DebugInitiator &di,
@@ -32,3 +34,20 @@ public:
     const char * get_name() const { return "binary"; }
 };
 
+
+/**
+ * @brief Write a streamed raw image contiguously from a load address.
+ */
+class BinaryStreamLoader : public ImageStreamLoader {
+private:
+    DebugInitiator &m_di;
+    uint64_t m_load_addr;
+    uint64_t m_pos = 0;
+
+public:
+    BinaryStreamLoader(DebugInitiator &di, uint64_t load_addr)
+        : m_di(di), m_load_addr(load_addr) {}
+
+    bool write(const uint8_t *data, size_t len);
+    void finish(ImageLoadResult &result);
+};
@@ -0,0 +1,433 @@
+/*
+ *  This file is part of Rabbits
+ *  Copyright (C) 2017  Clement Deschamps and Luc Michel
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <sys/types.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <elf.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rabbits/config.h"
+
+#ifdef RABBITS_CONFIG_ZLIB
+# include <zlib.h>
+#endif
+
+#ifdef RABBITS_CONFIG_ZSTD
+# include <zstd.h>
+#endif
+
+#include "rabbits/logger.h"
+#include "rabbits/component/debug_initiator.h"
+
+#include "compressed.h"
+#include "elf.h"
+#include "binary.h"
+
+/* Size of the compressed and decompressed chunks */
+static const size_t CHUNK_SIZE = 256 * 1024;
+
+enum CompressionFormat {
+    FORMAT_UNKNOWN,
+    FORMAT_GZIP,
+    FORMAT_ZSTD,
+};
+
+/* gzip magic number, followed by the deflate compression method */
+static const uint8_t GZIP_MAGIC[] = { 0x1f, 0x8b, 0x08 };
+static const uint8_t ZSTD_MAGIC[] = { 0x28, 0xb5, 0x2f, 0xfd };
+
+static CompressionFormat probe_format(const uint8_t *data, size_t len)
+{
+    if ((len >= sizeof(GZIP_MAGIC))
+        && (std::memcmp(data, GZIP_MAGIC, sizeof(GZIP_MAGIC)) == 0)) {
+        return FORMAT_GZIP;
+    }
+
+    if ((len >= sizeof(ZSTD_MAGIC))
+        && (std::memcmp(data, ZSTD_MAGIC, sizeof(ZSTD_MAGIC)) == 0)) {
+        return FORMAT_ZSTD;
+    }
+
+    return FORMAT_UNKNOWN;
+}
+
+/* Source of the compressed image, read chunk by chunk */
+class CompressedInput {
+public:
+    virtual ~CompressedInput() {}
+
+    /* Return false on error. len is set to zero at the end of the image. */
+    virtual bool next(const uint8_t *&data, size_t &len) = 0;
+};
+
+class MemoryInput : public CompressedInput {
+private:
+    const uint8_t *m_data;
+    size_t m_len;
+    size_t m_pos = 0;
+
+public:
+    MemoryInput(const void *data, size_t len)
+        : m_data(static_cast<const uint8_t*>(data)), m_len(len) {}
+
+    bool next(const uint8_t *&data, size_t &len)
+    {
+        data = m_data + m_pos;
+        len = std::min(m_len - m_pos, CHUNK_SIZE);
+        m_pos += len;
+        return true;
+    }
+};
+
+class FileInput : public CompressedInput {
+private:
+    int m_fd;
+    std::vector<uint8_t> m_buf;
+
+public:
+    explicit FileInput(int fd) : m_fd(fd), m_buf(CHUNK_SIZE) {}
+
+    bool next(const uint8_t *&data, size_t &len)
+    {
+        ssize_t ret;
+
+        do {
+            ret = read(m_fd, m_buf.data(), m_buf.size());
+        } while ((ret < 0) && (errno == EINTR));
+
+        if (ret < 0) {
+            perror("read");
+            return false;
+        }
+
+        data = m_buf.data();
+        len = ret;
+        return true;
+    }
+};
+
+/*
+ * Receive the decompressed image and hand it to the ELF or the binary stream
+ * loader, depending on its first bytes.
+ */
+class DecompressedImage : public ImageStreamLoader {
+private:
+    DebugInitiator &m_di;
+    uint64_t m_load_addr;
+
+    std::vector<uint8_t> m_head;
+    std::unique_ptr<ImageStreamLoader> m_loader;
+
+    bool select_loader()
+    {
+        std::vector<uint8_t> head;
+
+        if ((m_head.size() >= SELFMAG)
+            && (std::memcmp(m_head.data(), ELFMAG, SELFMAG) == 0)) {
+            LOG(APP, DBG) << "Decompressed image is an elf file\n";
+            m_loader.reset(new ElfStreamLoader(m_di));
+        } else {
+            m_loader.reset(new BinaryStreamLoader(m_di, m_load_addr));
+        }
+
+        head.swap(m_head);
+        return m_loader->write(head.data(), head.size());
+    }
+
+public:
+    DecompressedImage(DebugInitiator &di, uint64_t load_addr)
+        : m_di(di), m_load_addr(load_addr) {}
+
+    bool write(const uint8_t *data, size_t len)
+    {
+        if (m_loader) {
+            return m_loader->write(data, len);
+        }
+
+        m_head.insert(m_head.end(), data, data + len);
+
+        if (m_head.size() < SELFMAG) {
+            return true;
+        }
+
+        return select_loader();
+    }
+
+    void finish(ImageLoadResult &result)
+    {
+        if (!m_loader && !select_loader()) {
+            result.result = ImageLoadResult::LOAD_ERROR;
+            return;
+        }
+
+        m_loader->finish(result);
+    }
+};
+
+#ifdef RABBITS_CONFIG_ZLIB
+static bool decompress_gzip(CompressedInput &in, ImageStreamLoader &out,
+                            std::string &error)
+{
+    std::vector<uint8_t> buf(CHUNK_SIZE);
+    z_stream strm;
+    int ret = Z_OK;
+    bool ok = true;
+
+    std::memset(&strm, 0, sizeof(strm));
+
+    /* Only accept the gzip container */
+    if (inflateInit2(&strm, 16 + MAX_WBITS) != Z_OK) {
+        error = "unable to initialize zlib";
+        return false;
+    }
+
+    while (ok) {
+        const uint8_t *data;
+        size_t len;
+
+        if (!in.next(data, len)) {
+            ok = false;
+            break;
+        }
+
+        if (!len) {
+            break;
+        }
+
+        strm.next_in = const_cast<Bytef*>(data);
+        strm.avail_in = len;
+
+        for (;;) {
+            if (ret == Z_STREAM_END) {
+                if (!strm.avail_in) {
+                    break;
+                }
+
+                /* Concatenated gzip members */
+                inflateReset(&strm);
+            }
+
+            strm.next_out = buf.data();
+            strm.avail_out = buf.size();
+
+            ret = inflate(&strm, Z_NO_FLUSH);
+
+            if ((ret != Z_OK) && (ret != Z_STREAM_END) && (ret != Z_BUF_ERROR)) {
+                error = strm.msg ? strm.msg : "corrupted image";
+                ok = false;
+                break;
+            }
+
+            const size_t produced = buf.size() - strm.avail_out;
+
+            if (produced && !out.write(buf.data(), produced)) {
+                ok = false;
+                break;
+            }
+
+            if ((ret == Z_BUF_ERROR) || (!strm.avail_in && strm.avail_out)) {
+                break;
+            }
+        }
+    }
+
+    if (ok && (ret != Z_STREAM_END)) {
+        error = "truncated image";
+        ok = false;
+    }
+
+    inflateEnd(&strm);
+    return ok;
+}
+#endif
+
+#ifdef RABBITS_CONFIG_ZSTD
+static bool decompress_zstd(CompressedInput &in, ImageStreamLoader &out,
+                            std::string &error)
+{
+    std::vector<uint8_t> buf(CHUNK_SIZE);
+    ZSTD_DStream *zds;
+    size_t ret = 0;
+    bool ok = true;
+
+    zds = ZSTD_createDStream();
+    if (!zds || ZSTD_isError(ZSTD_initDStream(zds))) {
+        error = "unable to initialize zstd";
+        ZSTD_freeDStream(zds);
+        return false;
+    }
+
+    while (ok) {
+        const uint8_t *data;
+        size_t len;
+
+        if (!in.next(data, len)) {
+            ok = false;
+            break;
+        }
+
+        if (!len) {
+            break;
+        }
+
+        ZSTD_inBuffer zin = { data, len, 0 };
+
+        for (;;) {
+            ZSTD_outBuffer zout = { buf.data(), buf.size(), 0 };
+
+            ret = ZSTD_decompressStream(zds, &zout, &zin);
+
+            if (ZSTD_isError(ret)) {
+                error = ZSTD_getErrorName(ret);
+                ok = false;
+                break;
+            }
+
+            if (zout.pos && !out.write(buf.data(), zout.pos)) {
+                ok = false;
+                break;
+            }
+
+            if ((zin.pos == zin.size) && (zout.pos < zout.size)) {
+                break;
+            }
+        }
+    }
+
+    /* A non-zero hint means the last frame is incomplete */
+    if (ok && ret) {
+        error = "truncated image";
+        ok = false;
+    }
+
+    ZSTD_freeDStream(zds);
+    return ok;
+}
+#endif
+
+static void load_compressed(CompressionFormat fmt, CompressedInput &in,
+                            DebugInitiator &di, uint64_t load_addr,
+                            ImageLoadResult &result)
+{
+    DecompressedImage out(di, load_addr);
+    std::string error;
+    const char *name = "";
+    bool ok = false;
+
+    switch (fmt) {
+    case FORMAT_GZIP:
+        name = "gzip";
+#ifdef RABBITS_CONFIG_ZLIB
+        LOG(APP, DBG) << "Decompressing gzip image\n";
+        ok = decompress_gzip(in, out, error);
+#else
+        LOG(APP, WRN) << "Found what looks like a gzip compressed image, "
+                         "but Rabbits has been built without zlib support\n";
+        result.result = ImageLoadResult::INCOMPATIBLE;
+        return;
+#endif
+        break;
+
+    case FORMAT_ZSTD:
+        name = "zstd";
+#ifdef RABBITS_CONFIG_ZSTD
+        LOG(APP, DBG) << "Decompressing zstd image\n";
+        ok = decompress_zstd(in, out, error);
+#else
+        LOG(APP, WRN) << "Found what looks like a zstd compressed image, "
+                         "but Rabbits has been built without zstd support\n";
+        result.result = ImageLoadResult::INCOMPATIBLE;
+        return;
+#endif
+        break;
+
+    default:
+        break;
+    }
+
+    if (ok) {
+        out.finish(result);
+        return;
+    }
+
+    if (!error.empty()) {
+        LOG(APP, ERR) << "Error while decompressing " << name << " image: "
+                      << error << "\n";
+    }
+
+    result.result = ImageLoadResult::LOAD_ERROR;
+}
+
+void CompressedLoaderHelper::load_file(const std::string &fn, DebugInitiator &di,
+                                       uint64_t load_addr, ImageLoadResult &result)
+{
+    uint8_t magic[sizeof(ZSTD_MAGIC)];
+    CompressionFormat fmt;
+    ssize_t len;
+    int fd;
+
+    fd = open(fn.c_str(), O_RDONLY);
+    if (fd < 0) {
+        perror("open");
+        result.result = ImageLoadResult::LOAD_ERROR;
+        return;
+    }
+
+    len = pread(fd, magic, sizeof(magic), 0);
+    if (len < 0) {
+        perror("pread");
+        result.result = ImageLoadResult::LOAD_ERROR;
+        goto out;
+    }
+
+    fmt = probe_format(magic, len);
+    if (fmt == FORMAT_UNKNOWN) {
+        result.result = ImageLoadResult::INCOMPATIBLE;
+        goto out;
+    }
+
+    {
+        FileInput in(fd);
+        load_compressed(fmt, in, di, load_addr, result);
+    }
+
+out:
+    close(fd);
+}
+
+void CompressedLoaderHelper::load_data(const void *data, size_t len, DebugInitiator &di,
+                                       uint64_t load_addr, ImageLoadResult &result)
+{
+    CompressionFormat fmt = probe_format(static_cast<const uint8_t*>(data), len);
+
+    if (fmt == FORMAT_UNKNOWN) {
+        result.result = ImageLoadResult::INCOMPATIBLE;
+        return;
+    }
+
+    MemoryInput in(data, len);
+    load_compressed(fmt, in, di, load_addr, result);
+}
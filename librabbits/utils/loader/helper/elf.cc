@@ -24,87 +24,184 @@
 #include <fcntl.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
 #include "rabbits/logger.h"
 #include "rabbits/component/debug_initiator.h"
 #include "elf.h"
 
-static void resize_buffer(std::vector<uint8_t>& buf, uint64_t size)
+/* Upper bound of the program header table end in a streamed image */
+static const uint64_t MAX_STREAM_HEADER_SIZE = 1 << 20;
+
+/* Source of the bss zero-fill, written repeatedly */
+static const uint8_t ZERO_CHUNK[64 * 1024] = { 0 };
+
+static bool write_mem(DebugInitiator &bus, uint64_t addr,
+                      const void *data, uint64_t size)
+{
+    const uint64_t written = bus.debug_write(addr, data, size);
+
+    if (written < size) {
+        LOG_F(APP, ERR, "Only %" PRIu64 " bytes were written "
+              "over %" PRIu64 ". "
+              "Trying to write outside ram?\n",
+              written, size);
+        return false;
+    }
+
+    return true;
+}
+
+/*
+ * Clear the part of a segment not backed by the file. The fill stops at the
+ * end of the memory mapped at its address, as a bss running past it does not
+ * prevent the image contents from being loaded.
+ */
+static void zero_fill(DebugInitiator &bus, uint64_t addr, uint64_t size)
 {
-    if (buf.capacity() < size) {
-        buf.reserve(size);
+    while (size) {
+        const uint64_t chunk = std::min<uint64_t>(size, sizeof(ZERO_CHUNK));
+        const uint64_t written = bus.debug_write(addr, ZERO_CHUNK, chunk);
+
+        if (written < chunk) {
+            LOG_F(APP, WRN, "Elf bss not cleared past %08" PRIx64
+                  " (%" PRIu64 " bytes left), outside ram?\n",
+                  addr + written, size - written);
+            return;
+        }
+
+        addr += chunk;
+        size -= chunk;
     }
 }
 
+/*
+ * Decode the ELF header and the PT_LOAD program headers at the start of an
+ * image. Return 0 on success and a positive value on error. Return -1 if the
+ * image is too short, needed being set to the size required to go further.
+ */
 template <class T_hdr, class T_phdr>
-static int load_elf(int fd, DebugInitiator &bus, uint64_t *entry)
+static int parse_elf(const uint8_t *image, uint64_t size, uint64_t &entry,
+                     std::vector<ElfSegment> &segments, uint64_t &needed)
 {
     T_hdr hdr;
-    T_phdr *phdr = NULL;
-    ssize_t phdr_size;
     int i;
-    int64_t written;
-    std::vector<uint8_t> buf;
 
-    if (read(fd, &hdr, sizeof(hdr)) != sizeof(hdr)) {
-        goto fail;
+    if (size < sizeof(hdr)) {
+        needed = sizeof(hdr);
+        return -1;
     }
 
-    lseek(fd, hdr.e_phoff, SEEK_SET);
-    phdr = new T_phdr[hdr.e_phnum];
+    std::memcpy(&hdr, image, sizeof(hdr));
 
-    phdr_size = sizeof(phdr[0]) * hdr.e_phnum;
-    if (read(fd, phdr, phdr_size) != phdr_size) {
-        goto fail;
+    if (hdr.e_phoff > std::numeric_limits<uint64_t>::max() / 2) {
+        LOG(APP, ERR) << "Invalid elf program header table offset\n";
+        return 1;
     }
 
-    if (entry) {
-        *entry = static_cast<uint64_t>(hdr.e_entry);
+    needed = hdr.e_phoff + uint64_t(hdr.e_phnum) * sizeof(T_phdr);
+
+    if (size < needed) {
+        return -1;
     }
 
+    entry = static_cast<uint64_t>(hdr.e_entry);
+
     LOG_F(APP, DBG, "Loading elf with %d sections\n", hdr.e_phnum);
 
     for (i = 0; i < hdr.e_phnum; i++) {
-        T_phdr *ph = &phdr[i];
-
-        if (ph->p_type == PT_LOAD) {
-            LOG_F(APP, DBG, "Loading elf segment, start:%08" PRIx64
-                  ", size:%08" PRIx64 "\n",
-                  static_cast<uint64_t>(ph->p_paddr),
-                  static_cast<uint64_t>(ph->p_filesz));
-
-            const uint64_t offset = ph->p_offset;
-            const int64_t filesize = ph->p_filesz;
-
-            resize_buffer(buf, filesize);
-
-            if (lseek(fd, offset, SEEK_SET) < 0) {
-                perror("lseek");
-                goto fail;
-            }
-
-            if (read(fd, &(buf[0]), filesize) != filesize) {
-                LOG(APP, ERR) << "Error while reading elf file\n";
-                goto fail;
-            }
-
-            written = bus.debug_write(ph->p_paddr, &(buf[0]), filesize);
-
-            if (written < filesize) {
-                LOG_F(APP, ERR, "Only %" PRIu64 " bytes were written "
-                      "over %" PRIu64 ". "
-                      "Trying to write outside ram?\n",
-                      written, static_cast<uint64_t>(filesize));
-                goto fail;
-            }
+        T_phdr ph;
+        ElfSegment seg;
+
+        std::memcpy(&ph, image + hdr.e_phoff + i * sizeof(T_phdr), sizeof(ph));
+
+        if (ph.p_type != PT_LOAD) {
+            continue;
+        }
+
+        seg.addr = ph.p_paddr;
+        seg.offset = ph.p_offset;
+        seg.filesize = ph.p_filesz;
+        seg.memsize = std::max<uint64_t>(ph.p_memsz, seg.filesize);
+
+        if (seg.filesize > std::numeric_limits<uint64_t>::max() - seg.offset) {
+            LOG(APP, ERR) << "Invalid elf segment\n";
+            return 1;
         }
+
+        LOG_F(APP, DBG, "Loading elf segment, start:%08" PRIx64
+              ", size:%08" PRIx64 ", memsize:%08" PRIx64 "\n",
+              seg.addr, seg.filesize, seg.memsize);
+
+        segments.push_back(seg);
     }
 
-    delete [] phdr;
     return 0;
+}
 
-fail:
-    delete [] phdr;
-    return 1;
+static int parse_elf(const uint8_t *image, uint64_t size, uint64_t &entry,
+                     std::vector<ElfSegment> &segments, uint64_t &needed)
+{
+    if (size < EI_NIDENT) {
+        needed = EI_NIDENT;
+        return -1;
+    }
+
+    if (image[EI_CLASS] == ELFCLASS64) {
+        return parse_elf<Elf64_Ehdr, Elf64_Phdr>(image, size, entry, segments, needed);
+    } else {
+        return parse_elf<Elf32_Ehdr, Elf32_Phdr>(image, size, entry, segments, needed);
+    }
+}
+
+/*
+ * Load the PT_LOAD segments of an ELF image held in memory. The segment
+ * contents are written straight from the image, and the part of a segment
+ * that is not backed by the file (the bss) is cleared.
+ */
+static int load_elf(const uint8_t *image, uint64_t size, DebugInitiator &bus, uint64_t *entry)
+{
+    std::vector<ElfSegment> segments;
+    uint64_t e = 0, needed = 0;
+    int ret;
+
+    if ((size < EI_NIDENT) ||
+        image[0] != ELFMAG0 ||
+        image[1] != ELFMAG1 ||
+        image[2] != ELFMAG2 ||
+        image[3] != ELFMAG3) {
+        return 2;
+    }
+
+    ret = parse_elf(image, size, e, segments, needed);
+
+    if (ret < 0) {
+        LOG(APP, ERR) << "Truncated elf program header table\n";
+        return 1;
+    } else if (ret) {
+        return ret;
+    }
+
+    if (entry) {
+        *entry = e;
+    }
+
+    for (const ElfSegment &seg : segments) {
+        if ((seg.offset > size) || (seg.filesize > size - seg.offset)) {
+            LOG(APP, ERR) << "Error while reading elf file: truncated segment\n";
+            return 1;
+        }
+
+        if (seg.filesize && !write_mem(bus, seg.addr, image + seg.offset, seg.filesize)) {
+            return 1;
+        }
+
+        zero_fill(bus, seg.addr + seg.filesize, seg.memsize - seg.filesize);
+    }
+
+    return 0;
 }
 
 /**
@@ -112,6 +209,8 @@ fail:
  *
  * This method uses a DebugInitiator to write to the platform memory.
  * It can return the ELF entry point into the entry pointer if it is not NULL.
+ * The file is mapped read-only, so that the segments are written to the
+ * platform memory without any intermediate copy.
  *
  * @param[in] elf_fn Path to the ELF image to load.
  * @param[in,out] bus The DebugInitiator used to write to memory.
@@ -122,7 +221,8 @@ fail:
 static int load_elf(const std::string & elf_fn, DebugInitiator &bus, uint64_t *entry)
 {
     int fd, ret = 0;
-    uint8_t e_ident[EI_NIDENT];
+    struct stat st;
+    void *image;
 
     fd = open(elf_fn.c_str(), O_RDONLY);
     if (fd < 0) {
@@ -131,38 +231,35 @@ static int load_elf(const std::string & elf_fn, DebugInitiator &bus, uint64_t *e
         goto open_fail;
     }
 
-    if (read(fd, e_ident, sizeof(e_ident)) != sizeof(e_ident)) {
+    if (fstat(fd, &st) < 0) {
+        perror("fstat");
         ret = 1;
         goto fail;
     }
 
-    if (e_ident[0] != ELFMAG0 ||
-        e_ident[1] != ELFMAG1 ||
-        e_ident[2] != ELFMAG2 ||
-        e_ident[3] != ELFMAG3) {
+    if (st.st_size < EI_NIDENT) {
         ret = 2;
         goto fail;
     }
 
-    lseek(fd, 0, SEEK_SET);
-
-    if (e_ident[EI_CLASS] == ELFCLASS64) {
-        ret = load_elf<Elf64_Ehdr, Elf64_Phdr>(fd, bus, entry);
-    } else {
-        ret = load_elf<Elf32_Ehdr, Elf32_Phdr>(fd, bus, entry);
+    image = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (image == MAP_FAILED) {
+        perror("mmap");
+        ret = 1;
+        goto fail;
     }
 
+    ret = load_elf(static_cast<const uint8_t*>(image), st.st_size, bus, entry);
+
+    munmap(image, st.st_size);
 fail:
     close(fd);
 open_fail:
     return ret;
 }
 
-void ElfLoaderHelper::load_file(const std::string &fn, DebugInitiator &di,
-                                uint64_t load_addr, ImageLoadResult &result)
+static void set_result(int ret, ImageLoadResult &result)
 {
-    int ret = load_elf(fn, di, &result.entry_point);
-
     switch (ret) {
     case 0:
         result.result = ImageLoadResult::LOAD_SUCCESS;
@@ -176,10 +273,102 @@ void ElfLoaderHelper::load_file(const std::string &fn, DebugInitiator &di,
     }
 }
 
+void ElfLoaderHelper::load_file(const std::string &fn, DebugInitiator &di,
+                                uint64_t load_addr, ImageLoadResult &result)
+{
+    set_result(load_elf(fn, di, &result.entry_point), result);
+}
+
 void ElfLoaderHelper::load_data(const void *data, size_t len, DebugInitiator &di,
                                 uint64_t load_addr, ImageLoadResult &result)
 {
-    /* TODO */
-    result.result = ImageLoadResult::INCOMPATIBLE;
+    LOG_F(APP, DBG, "Loading elf image from memory (%zu bytes)\n", len);
+
+    set_result(load_elf(static_cast<const uint8_t*>(data), len, di, &result.entry_point),
+               result);
+}
+
+/*
+ * Return 0 once the program header table has been parsed, -1 if more data is
+ * needed, and a positive value on error.
+ */
+int ElfStreamLoader::parse_header()
+{
+    uint64_t needed = 0;
+    int ret;
+
+    ret = parse_elf(m_head.data(), m_head.size(), m_entry, m_segments, needed);
+
+    if ((ret < 0) && (needed > MAX_STREAM_HEADER_SIZE)) {
+        LOG(APP, ERR) << "Elf program header table is too far in the image\n";
+        return 1;
+    }
+
+    return ret;
+}
+
+bool ElfStreamLoader::load_chunk(const uint8_t *data, size_t len)
+{
+    const uint64_t start = m_pos;
+    const uint64_t end = m_pos + len;
+
+    for (const ElfSegment &seg : m_segments) {
+        const uint64_t b = std::max(start, seg.offset);
+        const uint64_t e = std::min(end, seg.offset + seg.filesize);
+
+        if (b >= e) {
+            continue;
+        }
+
+        if (!write_mem(m_di, seg.addr + (b - seg.offset), data + (b - start), e - b)) {
+            return false;
+        }
+    }
+
+    m_pos = end;
+    return true;
 }
 
+bool ElfStreamLoader::write(const uint8_t *data, size_t len)
+{
+    if (m_parsed) {
+        return load_chunk(data, len);
+    }
+
+    m_head.insert(m_head.end(), data, data + len);
+
+    int ret = parse_header();
+
+    if (ret) {
+        return ret < 0;
+    }
+
+    /* Replay the buffered part of the image */
+    std::vector<uint8_t> head;
+    head.swap(m_head);
+    m_parsed = true;
+
+    return load_chunk(head.data(), head.size());
+}
+
+void ElfStreamLoader::finish(ImageLoadResult &result)
+{
+    if (!m_parsed) {
+        LOG(APP, ERR) << "Truncated elf header\n";
+        set_result(1, result);
+        return;
+    }
+
+    for (const ElfSegment &seg : m_segments) {
+        if (seg.offset + seg.filesize > m_pos) {
+            LOG(APP, ERR) << "Error while reading elf stream: truncated segment\n";
+            set_result(1, result);
+            return;
+        }
+
+        zero_fill(m_di, seg.addr + seg.filesize, seg.memsize - seg.filesize);
+    }
+
+    result.entry_point = m_entry;
+    set_result(0, result);
+}
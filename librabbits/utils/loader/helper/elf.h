@@ -19,8 +19,12 @@
 
 #pragma once
 
+#include <vector>
+
 #include "rabbits/utils/loader/helper.h"
 
+#include "stream.h"
+
 class ElfLoaderHelper : public ImageLoaderHelper {
 public:
     void load_file(const std::string &fn, DebugInitiator &di,
@@ -31,3 +35,41 @@ public:
 
     const char * get_name() const { return "elf"; }
 };
+
+/**
+ * @brief A PT_LOAD segment of an ELF image.
+ */
+struct ElfSegment {
+    uint64_t addr;
+    uint64_t offset;
+    uint64_t filesize;
+    uint64_t memsize;
+};
+
+/**
+ * @brief Load a streamed ELF image.
+ *
+ * The ELF header and the program header table are buffered until they are
+ * complete. Then each chunk is written to the PT_LOAD segments it overlaps.
+ * The bss parts of the segments are cleared once the whole image has been
+ * received.
+ */
+class ElfStreamLoader : public ImageStreamLoader {
+private:
+    DebugInitiator &m_di;
+
+    std::vector<uint8_t> m_head;
+    std::vector<ElfSegment> m_segments;
+    bool m_parsed = false;
+    uint64_t m_entry = 0;
+    uint64_t m_pos = 0;
+
+    int parse_header();
+    bool load_chunk(const uint8_t *data, size_t len);
+
+public:
+    explicit ElfStreamLoader(DebugInitiator &di) : m_di(di) {}
+
+    bool write(const uint8_t *data, size_t len);
+    void finish(ImageLoadResult &result);
+};
@@ -0,0 +1,49 @@
+/*
+ *  This file is part of Rabbits
+ *  Copyright (C) 2017  Clement Deschamps and Luc Michel
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <inttypes.h>
+
+#include "rabbits/utils/loader/helper.h"
+
+/**
+ * @brief Consumer of an image received as a stream of chunks.
+ *
+ * Used when the image is produced on the fly (e.g. by a decompressor) and is
+ * never available as a whole in memory. Chunks are given in order, from the
+ * start of the image.
+ */
+class ImageStreamLoader {
+public:
+    virtual ~ImageStreamLoader() {}
+
+    /**
+     * @brief Consume the next chunk of the image.
+     *
+     * @return false if the load failed. No more chunks should be given then.
+     */
+    virtual bool write(const uint8_t *data, size_t len) = 0;
+
+    /**
+     * @brief Signal the end of the image and fill the load result.
+     */
+    virtual void finish(ImageLoadResult &result) = 0;
+};
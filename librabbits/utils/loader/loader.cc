@@ -22,6 +22,7 @@
 
 #include "helper/elf.h"
 #include "helper/binary.h"
+#include "helper/compressed.h"
 
 ImageLoader::ImageLoader()
 {
@@ -29,6 +30,7 @@ ImageLoader::ImageLoader()
     m_helpers.push_back(new BinaryLoaderHelper);
 
     register_helper(new ElfLoaderHelper);
+    register_helper(new CompressedLoaderHelper);
 }
 
 void ImageLoader::load_file(const std::string &fn, DebugInitiator &di,
@@ -0,0 +1,142 @@
+/*
+ *  This file is part of Rabbits
+ *  Copyright (C) 2017  Clement Deschamps and Luc Michel
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/*
+ * Cost of a bus access, with a payload taken from a pool and with a payload
+ * built on the stack for each transaction.
+ *
+ * usage: rabbits-bench-bus-access [count]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#include <systemc>
+#include <tlm>
+
+#include <rabbits/config/manager.h>
+#include <rabbits/component/master.h>
+#include <rabbits/component/memory_slave.h>
+#include <rabbits/datatypes/tlm_payload_pool.h>
+
+using std::chrono::steady_clock;
+using std::chrono::duration_cast;
+using std::chrono::nanoseconds;
+
+class BusAccessBench : public Master<> {
+protected:
+    const unsigned long m_count;
+    uint32_t m_data = 0;
+
+    static void fill(tlm::tlm_generic_payload &trans, uint32_t *data)
+    {
+        trans.set_command(tlm::TLM_READ_COMMAND);
+        trans.set_address(0);
+        trans.set_data_ptr(reinterpret_cast<uint8_t*>(data));
+        trans.set_data_length(sizeof(*data));
+        trans.set_streaming_width(sizeof(*data));
+        trans.set_byte_enable_ptr(NULL);
+        trans.set_byte_enable_length(0);
+        trans.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
+        trans.set_dmi_allowed(false);
+    }
+
+    /* What the port used to do */
+    void stack_payload()
+    {
+        sc_core::sc_time delay = sc_core::SC_ZERO_TIME;
+
+        for (unsigned long i = 0; i < m_count; i++) {
+            tlm::tlm_generic_payload trans;
+
+            fill(trans, &m_data);
+            p_bus.socket->b_transport(trans, delay);
+        }
+    }
+
+    void pooled_payload()
+    {
+        sc_core::sc_time delay = sc_core::SC_ZERO_TIME;
+        TlmPayloadPool pool;
+
+        for (unsigned long i = 0; i < m_count; i++) {
+            tlm::tlm_generic_payload *trans = pool.acquire();
+
+            fill(*trans, &m_data);
+            p_bus.socket->b_transport(*trans, delay);
+            pool.release(trans);
+        }
+    }
+
+    void port_access()
+    {
+        for (unsigned long i = 0; i < m_count; i++) {
+            p_bus.bus_read(0, reinterpret_cast<uint8_t*>(&m_data), sizeof(m_data));
+        }
+    }
+
+    void measure(const char *name, void (BusAccessBench::*f)())
+    {
+        const steady_clock::time_point start = steady_clock::now();
+
+        (this->*f)();
+
+        const double ns = duration_cast<nanoseconds>(steady_clock::now() - start).count();
+
+        std::printf("%-16s %8.1f ns/transaction\n", name, ns / m_count);
+    }
+
+    void bench()
+    {
+        measure("stack payload", &BusAccessBench::stack_payload);
+        measure("pooled payload", &BusAccessBench::pooled_payload);
+        measure("bus_read()", &BusAccessBench::port_access);
+
+        sc_core::sc_stop();
+    }
+
+public:
+    SC_HAS_PROCESS(BusAccessBench);
+    BusAccessBench(sc_core::sc_module_name n, ConfigManager &c, unsigned long count)
+        : Master(n, c), m_count(count)
+    {
+        SC_THREAD(bench);
+    }
+};
+
+int sc_main(int argc, char *argv[])
+{
+    const unsigned long count = (argc > 1) ? std::strtoul(argv[1], NULL, 0) : 1000000;
+
+    if (count == 0) {
+        std::fprintf(stderr, "usage: %s [count]\n", argv[0]);
+        return 1;
+    }
+
+    ConfigManager config;
+    BusAccessBench bench("bench", config, count);
+    MemorySlave<> ram("ram", config, 0x1000);
+
+    bench.p_bus.connect(ram.p_bus);
+
+    sc_core::sc_start();
+
+    return 0;
+}
@@ -0,0 +1,88 @@
+/*
+ *  This file is part of Rabbits
+ *  Copyright (C) 2017  Clement Deschamps and Luc Michel
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#define RABBITS_TEST_MOD bus_access_queue
+
+#include <thread>
+#include <atomic>
+
+#include <rabbits/test/test.h>
+#include <rabbits/component/memory_slave.h>
+#include <rabbits/component/bus_access_queue.h>
+
+class BusAccessQueueTestBench : public TestBench {
+protected:
+    MemorySlave<> m_ram;
+    DebugInitiator m_initiator;
+    BusAccessQueue m_queue;
+
+public:
+    BusAccessQueueTestBench(sc_core::sc_module_name n, ConfigManager &c)
+        : TestBench(n, c)
+        , m_ram("ram", c, 0x1000)
+        , m_initiator("initiator", c)
+        , m_queue("queue", m_initiator)
+    {
+        m_initiator.p_bus.connect(m_ram.p_bus);
+    }
+};
+
+RABBITS_UNIT_TESTBENCH(host_thread, BusAccessQueueTestBench)
+{
+    std::atomic<bool> done(false);
+    std::vector<uint8_t> data;
+    uint64_t written = 0;
+
+    std::thread host([&] {
+        const uint32_t v = 0xdeadbeef;
+
+        written = m_queue.write(0x100, &v, sizeof(v)).get();
+        data = m_queue.read(0xffe, 4).get();
+        done = true;
+    });
+
+    /* Keep the kernel running while the host thread waits */
+    while (!done) {
+        wait(1, sc_core::SC_NS);
+    }
+
+    host.join();
+
+    RABBITS_TEST_ASSERT_EQ(written, 4u);
+    RABBITS_TEST_ASSERT_EQ(*reinterpret_cast<uint32_t*>(m_ram.get_data() + 0x100), 0xdeadbeefu);
+
+    /* Debug reads are truncated at the end of the memory */
+    RABBITS_TEST_ASSERT_EQ(data.size(), 2u);
+}
+
+RABBITS_UNIT_TESTBENCH(no_callback, BusAccessQueueTestBench)
+{
+    const uint32_t v = 0x12345678;
+    bool done = false;
+
+    /* Accesses without a completion callback are processed as well */
+    m_queue.post_read(0x100, 4);
+    m_queue.post_write(0x200, &v, sizeof(v));
+    m_queue.post_write(0x204, &v, sizeof(v), [&done] (uint64_t) { done = true; });
+
+    wait(1, sc_core::SC_NS);
+
+    RABBITS_TEST_ASSERT(done);
+    RABBITS_TEST_ASSERT_EQ(*reinterpret_cast<uint32_t*>(m_ram.get_data() + 0x200), 0x12345678u);
+}
@@ -0,0 +1,135 @@
+/*
+ *  This file is part of Rabbits
+ *  Copyright (C) 2017  Clement Deschamps and Luc Michel
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#define RABBITS_TEST_MOD debug_initiator
+
+#include <cstring>
+#include <sstream>
+#include <vector>
+
+#include <rabbits/test/test.h>
+#include <rabbits/component/memory_slave.h>
+#include <rabbits/component/debug_initiator.h>
+
+#include "../../components/bus/generic_bus.h"
+
+/*
+ * A memory granting DMI at 0x0, followed by a large memory that does not,
+ * at 0x1000.
+ */
+class DebugInitiatorTestBench : public TestBench {
+protected:
+    static const uint64_t DMI_BASE = 0x0;
+    static const uint64_t DMI_SIZE = 0x1000;
+    static const uint64_t RAM_BASE = 0x1000;
+    static const uint64_t RAM_SIZE = 0x200000;
+
+    DebugInitiator m_initiator;
+    GenericBus<> m_bus;
+    MemorySlave<> m_dmi_ram;
+    MemorySlave<> m_ram;
+
+    void map(Port &target, uint64_t base, uint64_t size)
+    {
+        PlatformDescription d;
+        std::stringstream ss;
+
+        ss << "address: { 0x" << std::hex << base << ": 0x" << size << " }";
+        d.load_yaml(ss.str());
+
+        m_bus.p_bus.connect(target, d);
+    }
+
+    static std::vector<uint8_t> pattern(size_t size)
+    {
+        std::vector<uint8_t> v(size);
+
+        for (size_t i = 0; i < size; i++) {
+            v[i] = (i * 13 + (i >> 12)) & 0xff;
+        }
+
+        return v;
+    }
+
+public:
+    DebugInitiatorTestBench(sc_core::sc_module_name n, ConfigManager &c)
+        : TestBench(n, c)
+        , m_initiator("initiator", c)
+        , m_bus("bus", Parameters(), c)
+        , m_dmi_ram("dmi-ram", c, DMI_SIZE)
+        , m_ram("ram", c, RAM_SIZE)
+    {
+        m_ram.set_dmi_enabled(false);
+
+        m_initiator.p_bus.connect(m_bus.p_bus);
+        map(m_dmi_ram.p_bus, DMI_BASE, DMI_SIZE);
+        map(m_ram.p_bus, RAM_BASE, RAM_SIZE);
+    }
+};
+
+RABBITS_UNIT_TESTBENCH(dmi_region_end, DebugInitiatorTestBench)
+{
+    const std::vector<uint8_t> data = pattern(0x200);
+    std::vector<uint8_t> out(data.size());
+
+    /* The first half is copied through DMI, the rest goes through transport_dbg */
+    RABBITS_TEST_ASSERT_EQ(m_initiator.debug_write(0xf00, data.data(), data.size()),
+                           data.size());
+    RABBITS_TEST_ASSERT(std::memcmp(m_dmi_ram.get_data() + 0xf00, data.data(), 0x100) == 0);
+    RABBITS_TEST_ASSERT(std::memcmp(m_ram.get_data(), data.data() + 0x100, 0x100) == 0);
+
+    RABBITS_TEST_ASSERT_EQ(m_initiator.debug_read(0xf00, out.data(), out.size()),
+                           out.size());
+    RABBITS_TEST_ASSERT(out == data);
+}
+
+RABBITS_UNIT_TESTBENCH(large_write, DebugInitiatorTestBench)
+{
+    /* Larger than a debug transport chunk */
+    const std::vector<uint8_t> data = pattern(0x180000);
+
+    RABBITS_TEST_ASSERT_EQ(m_initiator.debug_write(RAM_BASE + 0x10, data.data(), data.size()),
+                           data.size());
+    RABBITS_TEST_ASSERT(std::memcmp(m_ram.get_data() + 0x10, data.data(), data.size()) == 0);
+}
+
+RABBITS_UNIT_TESTBENCH(partial_write, DebugInitiatorTestBench)
+{
+    const std::vector<uint8_t> data = pattern(0x100);
+    const uint64_t end = RAM_BASE + RAM_SIZE;
+
+    /* Nothing is mapped after the end of the memory */
+    RABBITS_TEST_ASSERT_EQ(m_initiator.debug_write(end - 0x80, data.data(), data.size()),
+                           0x80u);
+    RABBITS_TEST_ASSERT(std::memcmp(m_ram.get_data() + RAM_SIZE - 0x80, data.data(), 0x80) == 0);
+
+    RABBITS_TEST_ASSERT_EQ(m_initiator.debug_write(end, data.data(), data.size()), 0u);
+}
+
+RABBITS_UNIT_TESTBENCH(read_only_dmi, DebugInitiatorTestBench)
+{
+    const std::vector<uint8_t> data = pattern(0x20);
+
+    /* Write DMI is refused, debug writes still reach the memory */
+    m_dmi_ram.set_readonly(true);
+
+    RABBITS_TEST_ASSERT_EQ(m_initiator.debug_write(0x100, data.data(), data.size()),
+                           data.size());
+    RABBITS_TEST_ASSERT(std::memcmp(m_dmi_ram.get_data() + 0x100, data.data(), data.size()) == 0);
+}
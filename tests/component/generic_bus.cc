@@ -0,0 +1,248 @@
+/*
+ *  This file is part of Rabbits
+ *  Copyright (C) 2017  Clement Deschamps and Luc Michel
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#define RABBITS_TEST_MOD generic_bus
+
+#include <cstring>
+#include <sstream>
+
+#include <rabbits/test/test.h>
+#include <rabbits/test/slave_tester.h>
+#include <rabbits/component/memory_slave.h>
+
+#include "../../components/bus/generic_bus.h"
+
+/* Exposes the non-blocking routes in progress */
+class TestBus : public GenericBus<> {
+public:
+    TestBus(sc_core::sc_module_name n, ConfigManager &c)
+        : GenericBus(n, Parameters(), c) {}
+
+    size_t nb_route_count() const { return m_nb_routes.size(); }
+};
+
+/*
+ * Two memories, the second one being connected first, with a hole between
+ * them.
+ */
+class GenericBusTestBench : public TestBench {
+protected:
+    static const uint64_t RAM0_BASE = 0x0;
+    static const uint64_t RAM1_BASE = 0x10000;
+    static const uint64_t RAM_SIZE = 0x1000;
+
+    SlaveTester<> m_tester;
+    SlaveTester<> m_other;
+    TestBus m_bus;
+    MemorySlave<> m_ram0;
+    MemorySlave<> m_ram1;
+
+    void map(Port &target, uint64_t base, uint64_t size)
+    {
+        PlatformDescription d;
+        std::stringstream ss;
+
+        ss << "address: { 0x" << std::hex << base << ": 0x" << size << " }";
+        d.load_yaml(ss.str());
+
+        m_bus.p_bus.connect(target, d);
+    }
+
+    uint32_t ram_u32(MemorySlave<> &ram, uint64_t offset)
+    {
+        uint32_t value;
+        std::memcpy(&value, ram.get_data() + offset, sizeof(value));
+        return value;
+    }
+
+public:
+    GenericBusTestBench(sc_core::sc_module_name n, ConfigManager &c)
+        : TestBench(n, c)
+        , m_tester("tester", c)
+        , m_other("other", c)
+        , m_bus("bus", c)
+        , m_ram0("ram0", c, RAM_SIZE)
+        , m_ram1("ram1", c, RAM_SIZE)
+    {
+        m_tester.p_bus.connect(m_bus.p_bus);
+        m_other.p_bus.connect(m_bus.p_bus);
+        map(m_ram1.p_bus, RAM1_BASE, RAM_SIZE);
+        map(m_ram0.p_bus, RAM0_BASE, RAM_SIZE);
+    }
+};
+
+RABBITS_UNIT_TESTBENCH(decoding, GenericBusTestBench)
+{
+    m_tester.bus_write_u32(RAM0_BASE + 0x10, 0xcafe);
+    RABBITS_TEST_ASSERT(m_tester.last_access_succeeded());
+    m_tester.bus_write_u32(RAM1_BASE + 0x10, 0xbeef);
+    RABBITS_TEST_ASSERT(m_tester.last_access_succeeded());
+
+    RABBITS_TEST_ASSERT_EQ(ram_u32(m_ram0, 0x10), 0xcafeu);
+    RABBITS_TEST_ASSERT_EQ(ram_u32(m_ram1, 0x10), 0xbeefu);
+    RABBITS_TEST_ASSERT_EQ(m_tester.bus_read_u32(RAM1_BASE + 0x10), 0xbeefu);
+
+    /* In the hole, and across the end of a memory */
+    m_tester.bus_read_u32(RAM0_BASE + RAM_SIZE);
+    RABBITS_TEST_ASSERT(m_tester.last_access_failed());
+    m_tester.bus_write_u32(RAM1_BASE + RAM_SIZE - 2, 0);
+    RABBITS_TEST_ASSERT(m_tester.last_access_failed());
+}
+
+RABBITS_UNIT_TESTBENCH(dmi_translation, GenericBusTestBench)
+{
+    DmiInfo info;
+
+    RABBITS_TEST_ASSERT(m_tester.p_bus.dmi_probe(AddressRange(RAM1_BASE + 0x20, 4), info));
+    RABBITS_TEST_ASSERT_EQ(info.range.begin(), RAM1_BASE);
+    RABBITS_TEST_ASSERT_EQ(info.range.end(), RAM1_BASE + RAM_SIZE - 1);
+    RABBITS_TEST_ASSERT(info.ptr == m_ram1.get_data());
+
+    RABBITS_TEST_ASSERT(!m_tester.p_bus.dmi_probe(AddressRange(RAM0_BASE + RAM_SIZE, 4), info));
+}
+
+RABBITS_UNIT_TESTBENCH(dmi_denied, GenericBusTestBench)
+{
+    tlm::tlm_generic_payload trans;
+    tlm::tlm_dmi dmi;
+
+    /* The whole target has no DMI, in bus addresses */
+    m_ram1.set_dmi_enabled(false);
+    trans.set_address(RAM1_BASE + 0x20);
+    trans.set_command(tlm::TLM_READ_COMMAND);
+
+    RABBITS_TEST_ASSERT(!m_tester.p_bus.socket->get_direct_mem_ptr(trans, dmi));
+    RABBITS_TEST_ASSERT_EQ(trans.get_address(), RAM1_BASE + 0x20);
+    RABBITS_TEST_ASSERT_EQ(dmi.get_start_address(), RAM1_BASE);
+    RABBITS_TEST_ASSERT_EQ(dmi.get_end_address(), RAM1_BASE + RAM_SIZE - 1);
+
+    /* Nor has the hole between the memories */
+    dmi.init();
+    trans.set_address(RAM0_BASE + RAM_SIZE + 0x20);
+
+    RABBITS_TEST_ASSERT(!m_tester.p_bus.socket->get_direct_mem_ptr(trans, dmi));
+    RABBITS_TEST_ASSERT_EQ(dmi.get_start_address(), RAM0_BASE + RAM_SIZE);
+    RABBITS_TEST_ASSERT_EQ(dmi.get_end_address(), RAM1_BASE - 1);
+}
+
+RABBITS_UNIT_TESTBENCH(overlapping_range, GenericBusTestBench)
+{
+    bool thrown = false;
+
+    try {
+        map(m_ram0.p_bus, RAM1_BASE + RAM_SIZE / 2, RAM_SIZE);
+    } catch (RabbitsException &) {
+        thrown = true;
+    }
+
+    RABBITS_TEST_ASSERT(thrown);
+    RABBITS_TEST_ASSERT_EQ(m_bus.get_memory_mapping().size(), 2u);
+
+    /* The existing mapping is untouched */
+    m_tester.bus_write_u32(RAM1_BASE + RAM_SIZE - 4, 0xbeef);
+    RABBITS_TEST_ASSERT(m_tester.last_access_succeeded());
+    RABBITS_TEST_ASSERT_EQ(ram_u32(m_ram1, RAM_SIZE - 4), 0xbeefu);
+}
+
+RABBITS_UNIT_TESTBENCH(invalidate_broadcast, GenericBusTestBench)
+{
+    m_tester.p_bus.set_dmi_enabled(true);
+    m_other.p_bus.set_dmi_enabled(true);
+
+    /* The first accesses request the DMI regions, the next ones use them */
+    m_tester.bus_write_u32(RAM1_BASE, 1);
+    m_other.bus_write_u32(RAM1_BASE, 2);
+    m_tester.bus_write_u32(RAM1_BASE, 3);
+    m_other.bus_write_u32(RAM1_BASE, 4);
+    RABBITS_TEST_ASSERT_EQ(m_tester.p_bus.get_stats().dmi_accesses, 1u);
+    RABBITS_TEST_ASSERT_EQ(m_other.p_bus.get_stats().dmi_accesses, 1u);
+
+    /* Both initiators must drop their write grant */
+    m_ram1.set_readonly(true);
+
+    m_tester.bus_write_u32(RAM1_BASE, 5);
+    RABBITS_TEST_ASSERT(m_tester.last_access_failed());
+    m_other.bus_write_u32(RAM1_BASE, 6);
+    RABBITS_TEST_ASSERT(m_other.last_access_failed());
+    RABBITS_TEST_ASSERT_EQ(ram_u32(m_ram1, 0), 4u);
+}
+
+RABBITS_UNIT_TESTBENCH(nb_routes, GenericBusTestBench)
+{
+    uint32_t data[2] = { 0x1234, 0x5678 };
+
+    tlm::tlm_generic_payload *t0 =
+        m_tester.nb_bus_write(RAM0_BASE + 0x40, reinterpret_cast<uint8_t*>(data), 4);
+    tlm::tlm_generic_payload *t1 =
+        m_other.nb_bus_write(RAM1_BASE + 0x40, reinterpret_cast<uint8_t*>(data + 1), 4);
+
+    t0->acquire();
+    t1->acquire();
+
+    m_tester.wait_nb_outstanding();
+    m_other.wait_nb_outstanding();
+
+    /* Routes are released and the initiator addresses restored */
+    RABBITS_TEST_ASSERT_EQ(m_bus.nb_route_count(), 0u);
+    RABBITS_TEST_ASSERT(t0->is_response_ok());
+    RABBITS_TEST_ASSERT(t1->is_response_ok());
+    RABBITS_TEST_ASSERT_EQ(t0->get_address(), RAM0_BASE + 0x40);
+    RABBITS_TEST_ASSERT_EQ(t1->get_address(), RAM1_BASE + 0x40);
+    RABBITS_TEST_ASSERT_EQ(ram_u32(m_ram0, 0x40), 0x1234u);
+    RABBITS_TEST_ASSERT_EQ(ram_u32(m_ram1, 0x40), 0x5678u);
+
+    t0->release();
+    t1->release();
+
+    /* Non-mapped accesses complete right away, without a route */
+    tlm::tlm_generic_payload *t2 =
+        m_tester.nb_bus_read(RAM0_BASE + RAM_SIZE, reinterpret_cast<uint8_t*>(data), 4);
+
+    t2->acquire();
+    m_tester.wait_nb_outstanding();
+    RABBITS_TEST_ASSERT_EQ(m_bus.nb_route_count(), 0u);
+    RABBITS_TEST_ASSERT(t2->is_response_error());
+    t2->release();
+}
+
+RABBITS_UNIT_TESTBENCH(memory_mapping, GenericBusTestBench)
+{
+    MemoryMapping mapping;
+    uint64_t offset;
+
+    RABBITS_TEST_ASSERT(m_bus.lookup_target(RAM1_BASE + 0x123, mapping, offset));
+    RABBITS_TEST_ASSERT(mapping.target == &m_ram1);
+    RABBITS_TEST_ASSERT_EQ(mapping.range.begin(), RAM1_BASE);
+    RABBITS_TEST_ASSERT_EQ(mapping.range.size(), RAM_SIZE);
+    RABBITS_TEST_ASSERT_EQ(offset, 0x123u);
+
+    RABBITS_TEST_ASSERT(!m_bus.lookup_target(RAM0_BASE + RAM_SIZE, mapping, offset));
+
+    /* Sorted by address, whatever the connection order */
+    MemoryMappingView view = m_bus.get_memory_mapping_view();
+    MemoryMappingView::const_iterator it = view.begin();
+
+    RABBITS_TEST_ASSERT_EQ(view.size(), 2u);
+    RABBITS_TEST_ASSERT(it[0].target == &m_ram0);
+    RABBITS_TEST_ASSERT_EQ(it[0].range.begin(), RAM0_BASE);
+    RABBITS_TEST_ASSERT(it[1].target == &m_ram1);
+    RABBITS_TEST_ASSERT_EQ(it[1].range.begin(), RAM1_BASE);
+
+    RABBITS_TEST_ASSERT_EQ(m_bus.get_memory_mapping().size(), 2u);
+}
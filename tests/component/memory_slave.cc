@@ -0,0 +1,235 @@
+/*
+ *  This file is part of Rabbits
+ *  Copyright (C) 2017  Clement Deschamps and Luc Michel
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#define RABBITS_TEST_MOD memory_slave
+
+#include <cstring>
+
+#include <rabbits/test/test.h>
+#include <rabbits/test/slave_tester.h>
+#include <rabbits/component/memory_slave.h>
+
+/* Looks at the initiator information seen by a memory when its DMI is revoked */
+class RevokeTester : public SlaveTester<> {
+public:
+    MemorySlave<> *m_ram = nullptr;
+    bool m_has_info = false;
+    uint32_t m_id = 0;
+
+    RevokeTester(sc_core::sc_module_name n, ConfigManager &c)
+        : SlaveTester(n, c) {}
+
+    void invalidate_direct_mem_ptr(sc_dt::uint64 start_range, sc_dt::uint64 end_range)
+    {
+        const TlmInitiatorInfo *info = m_ram->get_initiator_info();
+
+        m_has_info = (info != nullptr);
+
+        if (m_has_info) {
+            m_id = info->get_id();
+        }
+
+        SlaveTester::invalidate_direct_mem_ptr(start_range, end_range);
+    }
+};
+
+class MemorySlaveTestBench : public TestBench {
+protected:
+    MemorySlave<> m_ram;
+    SlaveTester<> m_tester;
+
+    /* Delay annotated by the last call to transport() */
+    sc_core::sc_time m_delay;
+
+    tlm::tlm_response_status transport(tlm::tlm_command cmd, uint64_t addr,
+                                       uint8_t *data, unsigned int len,
+                                       unsigned int width,
+                                       uint8_t *be = nullptr,
+                                       unsigned int be_len = 0)
+    {
+        tlm::tlm_generic_payload trans;
+        sc_core::sc_time delay = sc_core::SC_ZERO_TIME;
+
+        trans.set_command(cmd);
+        trans.set_address(addr);
+        trans.set_data_ptr(data);
+        trans.set_data_length(len);
+        trans.set_streaming_width(width);
+        trans.set_byte_enable_ptr(be);
+        trans.set_byte_enable_length(be_len);
+        trans.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
+
+        m_tester.p_bus.socket->b_transport(trans, delay);
+        m_delay = delay;
+
+        return trans.get_response_status();
+    }
+
+public:
+    MemorySlaveTestBench(sc_core::sc_module_name n, ConfigManager &c)
+        : TestBench(n, c)
+        , m_ram("ram", c, 0x1000)
+        , m_tester("tester", c)
+    {
+        m_ram.set_latencies(sc_core::sc_time(10, sc_core::SC_NS),
+                            sc_core::sc_time(20, sc_core::SC_NS));
+        m_tester.connect_component(m_ram);
+    }
+};
+
+RABBITS_UNIT_TESTBENCH(access, MemorySlaveTestBench)
+{
+    m_tester.bus_write_u32(0x100, 0xcafebabe);
+    RABBITS_TEST_ASSERT(m_tester.last_access_succeeded());
+    RABBITS_TEST_ASSERT_EQ(m_tester.bus_read_u32(0x100), 0xcafebabe);
+    RABBITS_TEST_ASSERT_EQ(m_tester.debug_read_u32_nofail(0x100), 0xcafebabe);
+
+    m_tester.bus_read_u32(0xffe);
+    RABBITS_TEST_ASSERT(!m_tester.last_access_succeeded());
+
+    m_ram.set_readonly(true);
+    m_tester.bus_write_u32(0x100, 0);
+    RABBITS_TEST_ASSERT(!m_tester.last_access_succeeded());
+    RABBITS_TEST_ASSERT_EQ(m_tester.bus_read_u32(0x100), 0xcafebabe);
+}
+
+RABBITS_UNIT_TESTBENCH(latencies, MemorySlaveTestBench)
+{
+    const sc_core::sc_time ns(1, sc_core::SC_NS);
+    uint8_t data[4] = { 1, 2, 3, 4 };
+    uint8_t be[4] = { TLM_BYTE_ENABLED, TLM_BYTE_DISABLED,
+                      TLM_BYTE_ENABLED, TLM_BYTE_ENABLED };
+
+    RABBITS_TEST_ASSERT_EQ(transport(tlm::TLM_WRITE_COMMAND, 0x40, data, 4, 4),
+                           tlm::TLM_OK_RESPONSE);
+    RABBITS_TEST_ASSERT_EQ(m_delay, 20 * ns);
+
+    /* Byte-enabled and streamed accesses are charged once as well */
+    std::memset(m_ram.get_data() + 0x40, 0, 4);
+    RABBITS_TEST_ASSERT_EQ(transport(tlm::TLM_WRITE_COMMAND, 0x40, data, 4, 4, be, 4),
+                           tlm::TLM_OK_RESPONSE);
+    RABBITS_TEST_ASSERT_EQ(m_delay, 20 * ns);
+
+    const uint8_t expected[4] = { 1, 0, 3, 4 };
+    RABBITS_TEST_ASSERT(std::memcmp(m_ram.get_data() + 0x40, expected, 4) == 0);
+
+    RABBITS_TEST_ASSERT_EQ(transport(tlm::TLM_READ_COMMAND, 0x40, data, 4, 2),
+                           tlm::TLM_OK_RESPONSE);
+    RABBITS_TEST_ASSERT_EQ(m_delay, 10 * ns);
+}
+
+RABBITS_UNIT_TESTBENCH(dmi, MemorySlaveTestBench)
+{
+    DmiInfo info;
+
+    RABBITS_TEST_ASSERT(m_tester.p_bus.dmi_probe(AddressRange(0, 4), info));
+    RABBITS_TEST_ASSERT(info.ptr == m_ram.get_data());
+    RABBITS_TEST_ASSERT_EQ(info.range.size(), 0x1000u);
+    RABBITS_TEST_ASSERT(info.write_allowed);
+    RABBITS_TEST_ASSERT_EQ(info.read_latency, sc_core::sc_time(10, sc_core::SC_NS));
+
+    /* The first access fills the initiator DMI cache, the next ones use it */
+    m_tester.p_bus.set_dmi_enabled(true);
+    m_tester.bus_write_u32(0x10, 1);
+    *reinterpret_cast<uint32_t*>(m_ram.get_data() + 0x10) = 2;
+    RABBITS_TEST_ASSERT_EQ(m_tester.bus_read_u32(0x10), 2u);
+
+    /* Revoked write access is seen by the initiator */
+    m_ram.set_readonly(true);
+    m_tester.bus_write_u32(0x10, 3);
+    RABBITS_TEST_ASSERT(!m_tester.last_access_succeeded());
+    RABBITS_TEST_ASSERT_EQ(m_tester.bus_read_u32(0x10), 2u);
+
+    RABBITS_TEST_ASSERT(m_tester.p_bus.dmi_probe(AddressRange(0, 4), info));
+    RABBITS_TEST_ASSERT(!info.write_allowed);
+}
+
+RABBITS_UNIT_TESTBENCH(exclusive, MemorySlaveTestBench)
+{
+    uint32_t v = 0;
+
+    RABBITS_TEST_ASSERT(m_tester.bus_read_exclusive(0x200, reinterpret_cast<uint8_t*>(&v), 4));
+    v = 42;
+    RABBITS_TEST_ASSERT(m_tester.bus_write_exclusive(0x200, reinterpret_cast<uint8_t*>(&v), 4));
+    RABBITS_TEST_ASSERT_EQ(m_tester.bus_read_u32(0x200), 42u);
+
+    /* The reservation is consumed by the store */
+    v = 43;
+    RABBITS_TEST_ASSERT(!m_tester.bus_write_exclusive(0x200, reinterpret_cast<uint8_t*>(&v), 4));
+    RABBITS_TEST_ASSERT_EQ(m_tester.bus_read_u32(0x200), 42u);
+
+    /* A plain write in the granule breaks it, even with DMI enabled */
+    m_tester.p_bus.set_dmi_enabled(true);
+    m_tester.bus_write_u32(0x204, 0);
+    RABBITS_TEST_ASSERT(m_tester.bus_read_exclusive(0x200, reinterpret_cast<uint8_t*>(&v), 4));
+    m_tester.bus_write_u32(0x204, 1);
+    RABBITS_TEST_ASSERT(!m_tester.bus_write_exclusive(0x200, reinterpret_cast<uint8_t*>(&v), 4));
+
+    /* A failed store-exclusive is still a write access of the memory */
+    const uint64_t writes = m_ram.p_bus.get_stats().writes;
+    RABBITS_TEST_ASSERT(!m_tester.bus_write_exclusive(0x200, reinterpret_cast<uint8_t*>(&v), 4));
+    RABBITS_TEST_ASSERT_EQ(m_ram.p_bus.get_stats().writes, writes + 1);
+
+    /* A rejected write does not break the reservation */
+    RABBITS_TEST_ASSERT(m_tester.bus_read_exclusive(0x200, reinterpret_cast<uint8_t*>(&v), 4));
+    m_ram.set_readonly(true);
+    m_tester.bus_write_u32(0x204, 2);
+    RABBITS_TEST_ASSERT(m_tester.last_access_failed());
+    m_ram.set_readonly(false);
+    RABBITS_TEST_ASSERT(m_tester.bus_write_exclusive(0x200, reinterpret_cast<uint8_t*>(&v), 4));
+
+    /* DMI is still granted outside of the reserved granule */
+    DmiInfo info;
+    RABBITS_TEST_ASSERT(m_tester.bus_read_exclusive(0x200, reinterpret_cast<uint8_t*>(&v), 4));
+    RABBITS_TEST_ASSERT(!m_tester.p_bus.dmi_probe(AddressRange(0x210, 4), info));
+    RABBITS_TEST_ASSERT(m_tester.p_bus.dmi_probe(AddressRange(0x10, 4), info));
+    RABBITS_TEST_ASSERT_EQ(info.range.end(), 0x1ffu);
+}
+
+class InitiatorInfoTestBench : public TestBench {
+protected:
+    MemorySlave<> m_ram;
+    RevokeTester m_tester;
+
+public:
+    InitiatorInfoTestBench(sc_core::sc_module_name n, ConfigManager &c)
+        : TestBench(n, c)
+        , m_ram("ram", c, 0x1000)
+        , m_tester("tester", c)
+    {
+        m_tester.m_ram = &m_ram;
+        m_tester.connect_component(m_ram);
+    }
+};
+
+RABBITS_UNIT_TESTBENCH(initiator_info, InitiatorInfoTestBench)
+{
+    DmiInfo info;
+    uint32_t v;
+
+    m_tester.get_extension_slot<TlmInitiatorInfo>().set_id(5);
+
+    /* The exclusive read revokes the DMI granted, from the fast path */
+    RABBITS_TEST_ASSERT(m_tester.p_bus.dmi_probe(AddressRange(0x200, 4), info));
+    RABBITS_TEST_ASSERT(m_tester.bus_read_exclusive(0x200, reinterpret_cast<uint8_t*>(&v), 4));
+    RABBITS_TEST_ASSERT(m_tester.m_has_info);
+    RABBITS_TEST_ASSERT_EQ(m_tester.m_id, 5u);
+
+    RABBITS_TEST_ASSERT(m_ram.get_initiator_info() == nullptr);
+}
@@ -0,0 +1,154 @@
+/*
+ *  This file is part of Rabbits
+ *  Copyright (C) 2017  Clement Deschamps and Luc Michel
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#define RABBITS_TEST_MOD register_bank
+
+#include <rabbits/test/test.h>
+#include <rabbits/test/slave_tester.h>
+#include <rabbits/component/register_bank.h>
+
+class TimerSlave : public RegisterSlave<TimerSlave> {
+public:
+    enum {
+        CTRL = 0x0,
+        STATUS = 0x4,
+        PRESCALER = 0x8,
+        COUNTER = 0x10,
+    };
+
+    static const Register<TimerSlave> REGS[];
+
+    unsigned int m_status_reads = 0;
+
+    TimerSlave(sc_core::sc_module_name n, ConfigManager &c);
+
+    /* Status is cleared on read */
+    uint64_t status_read(uint64_t value)
+    {
+        m_status_reads++;
+        m_regs.set(STATUS, 0);
+        return value;
+    }
+
+    /* Only the low byte of the control register is implemented */
+    uint64_t ctrl_write(uint64_t old_value, uint64_t new_value)
+    {
+        if (new_value & 1) {
+            m_regs.set(STATUS, 1);
+        }
+
+        return new_value & 0xff;
+    }
+};
+
+const Register<TimerSlave> TimerSlave::REGS[] = {
+    { "ctrl",      CTRL,      4, REG_RW, 0,      nullptr,                  &TimerSlave::ctrl_write },
+    { "status",    STATUS,    4, REG_RO, 0,      &TimerSlave::status_read, nullptr },
+    { "prescaler", PRESCALER, 2, REG_RW, 0x1234, nullptr,                  nullptr },
+    { "counter",   COUNTER,   8, REG_RW, 0,      nullptr,                  nullptr },
+};
+
+TimerSlave::TimerSlave(sc_core::sc_module_name n, ConfigManager &c)
+    : RegisterSlave(n, c, REGS)
+{}
+
+class RegisterBankTestBench : public TestBench {
+protected:
+    TimerSlave m_slave;
+    SlaveTester<> m_tester;
+
+public:
+    RegisterBankTestBench(sc_core::sc_module_name n, ConfigManager &c)
+        : TestBench(n, c)
+        , m_slave("slave", c)
+        , m_tester("tester", c)
+    {
+        m_tester.connect_component(m_slave);
+    }
+};
+
+RABBITS_UNIT_TESTBENCH(access, RegisterBankTestBench)
+{
+    RABBITS_TEST_ASSERT_EQ(m_tester.bus_read_u16(TimerSlave::PRESCALER), 0x1234);
+
+    m_tester.bus_write_u32(TimerSlave::CTRL, 0xffffff01);
+    RABBITS_TEST_ASSERT(m_tester.last_access_succeeded());
+    RABBITS_TEST_ASSERT_EQ(m_tester.bus_read_u32(TimerSlave::CTRL), 0x01u);
+
+    /* Hooks */
+    RABBITS_TEST_ASSERT_EQ(m_tester.bus_read_u32(TimerSlave::STATUS), 1u);
+    RABBITS_TEST_ASSERT_EQ(m_tester.bus_read_u32(TimerSlave::STATUS), 0u);
+    RABBITS_TEST_ASSERT_EQ(m_slave.m_status_reads, 2u);
+
+    /* Access rights and holes */
+    m_tester.bus_write_u32(TimerSlave::STATUS, 1);
+    RABBITS_TEST_ASSERT(!m_tester.last_access_succeeded());
+    m_tester.bus_read_u32(0xc);
+    RABBITS_TEST_ASSERT(!m_tester.last_access_succeeded());
+    m_tester.bus_read_u32(0x100);
+    RABBITS_TEST_ASSERT(!m_tester.last_access_succeeded());
+}
+
+RABBITS_UNIT_TESTBENCH(partial_access, RegisterBankTestBench)
+{
+    m_tester.bus_write_u64(TimerSlave::COUNTER, 0x1122334455667788ull);
+    RABBITS_TEST_ASSERT_EQ(m_tester.bus_read_u32(TimerSlave::COUNTER + 4), 0x11223344u);
+
+    m_tester.bus_write_u8(TimerSlave::COUNTER + 1, 0xaa);
+    RABBITS_TEST_ASSERT_EQ(m_tester.bus_read_u64(TimerSlave::COUNTER), 0x112233445566aa88ull);
+
+    /* Spanning two registers */
+    RABBITS_TEST_ASSERT_EQ(m_tester.bus_read_u64(TimerSlave::CTRL), 0u);
+    RABBITS_TEST_ASSERT(m_tester.last_access_succeeded());
+}
+
+RABBITS_UNIT_TESTBENCH(spanning_rights, RegisterBankTestBench)
+{
+    /* Control is writable but status is not: nothing is written */
+    m_tester.bus_write_u64(TimerSlave::CTRL, 0x0000000100000001ull);
+    RABBITS_TEST_ASSERT(m_tester.last_access_failed());
+    RABBITS_TEST_ASSERT_EQ(m_tester.debug_read_u32_nofail(TimerSlave::CTRL), 0u);
+    RABBITS_TEST_ASSERT_EQ(m_tester.debug_read_u32_nofail(TimerSlave::STATUS), 0u);
+
+    /* Status is readable but the prescaler is followed by a hole */
+    uint8_t status = 1;
+
+    m_tester.debug_access_nofail(tlm::TLM_WRITE_COMMAND, TimerSlave::STATUS,
+                                 &status, sizeof(status));
+    m_tester.bus_read_u64(TimerSlave::STATUS);
+    RABBITS_TEST_ASSERT(m_tester.last_access_failed());
+    RABBITS_TEST_ASSERT_EQ(m_slave.m_status_reads, 0u);
+    RABBITS_TEST_ASSERT_EQ(m_tester.debug_read_u32_nofail(TimerSlave::STATUS), 1u);
+}
+
+RABBITS_UNIT_TESTBENCH(debug_and_reset, RegisterBankTestBench)
+{
+    uint8_t buf[2] = { 0xcd, 0xab };
+
+    /* Debug accesses ignore access rights and hooks */
+    m_tester.debug_access_nofail(tlm::TLM_WRITE_COMMAND, TimerSlave::STATUS,
+                                 buf, sizeof(buf));
+    RABBITS_TEST_ASSERT_EQ(m_tester.debug_read_u32_nofail(TimerSlave::STATUS), 0xabcdu);
+    RABBITS_TEST_ASSERT_EQ(m_slave.m_status_reads, 0u);
+
+    m_tester.bus_write_u16(TimerSlave::PRESCALER, 0x42);
+    m_slave.reset();
+    RABBITS_TEST_ASSERT_EQ(m_tester.bus_read_u16(TimerSlave::PRESCALER), 0x1234);
+    RABBITS_TEST_ASSERT_EQ(m_tester.bus_read_u32(TimerSlave::STATUS), 0u);
+}
@@ -0,0 +1,437 @@
+/*
+ *  This file is part of Rabbits
+ *  Copyright (C) 2017  Clement Deschamps and Luc Michel
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#define RABBITS_TEST_MOD slave
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include <rabbits/test/test.h>
+#include <rabbits/test/slave_tester.h>
+#include <rabbits/component/slave.h>
+#include <rabbits/component/fast_slave.h>
+
+/* Byte array supporting all the access sizes, and logging them */
+class ArraySlave : public Slave<> {
+public:
+    uint8_t m_mem[0x40];
+    std::vector<unsigned int> m_sizes;
+
+    /* Initiator information of the last access, if any */
+    bool m_has_info = false;
+    TlmInitiatorInfo m_info;
+
+    ArraySlave(sc_core::sc_module_name n, ConfigManager &c)
+        : Slave(n, c)
+    {
+        std::memset(m_mem, 0, sizeof(m_mem));
+    }
+
+    void log_info()
+    {
+        const TlmInitiatorInfo *info = get_initiator_info();
+
+        m_has_info = (info != nullptr);
+
+        if (m_has_info) {
+            m_info = *info;
+        }
+    }
+
+    template <typename T>
+    void read(uint64_t addr, T *value, bool &bErr)
+    {
+        log_info();
+
+        if (addr + sizeof(T) > sizeof(m_mem)) {
+            bErr = true;
+            return;
+        }
+
+        m_sizes.push_back(sizeof(T));
+        std::memcpy(value, m_mem + addr, sizeof(T));
+    }
+
+    template <typename T>
+    void write(uint64_t addr, T *value, bool &bErr)
+    {
+        log_info();
+
+        if (addr + sizeof(T) > sizeof(m_mem)) {
+            bErr = true;
+            return;
+        }
+
+        m_sizes.push_back(sizeof(T));
+        std::memcpy(m_mem + addr, value, sizeof(T));
+    }
+
+    void bus_cb_read_8(uint64_t a, uint8_t *v, bool &e) { read(a, v, e); }
+    void bus_cb_read_16(uint64_t a, uint16_t *v, bool &e) { read(a, v, e); }
+    void bus_cb_read_32(uint64_t a, uint32_t *v, bool &e) { read(a, v, e); }
+    void bus_cb_read_64(uint64_t a, uint64_t *v, bool &e) { read(a, v, e); }
+
+    void bus_cb_write_8(uint64_t a, uint8_t *v, bool &e) { write(a, v, e); }
+    void bus_cb_write_16(uint64_t a, uint16_t *v, bool &e) { write(a, v, e); }
+    void bus_cb_write_32(uint64_t a, uint32_t *v, bool &e) { write(a, v, e); }
+    void bus_cb_write_64(uint64_t a, uint64_t *v, bool &e) { write(a, v, e); }
+
+    uint64_t debug_read(uint64_t addr, uint8_t *buf, uint64_t size)
+    {
+        if (addr >= sizeof(m_mem)) {
+            return 0;
+        }
+
+        size = std::min<uint64_t>(size, sizeof(m_mem) - addr);
+        std::memcpy(buf, m_mem + addr, size);
+        return size;
+    }
+};
+
+/* 32 bits register file, with its own block write handler */
+class FastRegSlave : public FastSlave<FastRegSlave> {
+    friend class FastSlave<FastRegSlave>;
+
+public:
+    uint32_t m_regs[4] = { 0 };
+    unsigned int m_block_writes = 0;
+
+    FastRegSlave(sc_core::sc_module_name n, ConfigManager &c)
+        : FastSlave(n, c) {}
+
+private:
+    /* Callbacks kept private, reached through the friend declaration */
+    void bus_cb_read_32(uint64_t addr, uint32_t *value, bool &bErr)
+    {
+        *value = m_regs[(addr >> 2) & 3];
+    }
+
+    void bus_cb_write_32(uint64_t addr, uint32_t *value, bool &bErr)
+    {
+        m_regs[(addr >> 2) & 3] = *value;
+    }
+
+    void bus_cb_write_block(uint64_t addr, uint8_t *data, unsigned int len, bool &bErr)
+    {
+        m_block_writes++;
+        std::memcpy(m_regs, data, std::min<unsigned int>(len, sizeof(m_regs)));
+    }
+};
+
+class FastSlaveTestBench : public TestBench {
+protected:
+    FastRegSlave m_slave;
+    SlaveTester<> m_tester;
+
+public:
+    FastSlaveTestBench(sc_core::sc_module_name n, ConfigManager &c)
+        : TestBench(n, c)
+        , m_slave("slave", c)
+        , m_tester("tester", c)
+    {
+        m_tester.connect_component(m_slave);
+    }
+};
+
+class SlaveTestBench : public TestBench {
+protected:
+    ArraySlave m_slave;
+    SlaveTester<> m_tester;
+
+    /* Delay annotated by the last call to transport() */
+    sc_core::sc_time m_delay;
+
+    tlm::tlm_response_status transport(tlm::tlm_command cmd, uint64_t addr,
+                                       uint8_t *data, unsigned int len,
+                                       unsigned int width,
+                                       uint8_t *be = nullptr,
+                                       unsigned int be_len = 0)
+    {
+        tlm::tlm_generic_payload trans;
+        sc_core::sc_time delay = sc_core::SC_ZERO_TIME;
+
+        trans.set_command(cmd);
+        trans.set_address(addr);
+        trans.set_data_ptr(data);
+        trans.set_data_length(len);
+        trans.set_streaming_width(width);
+        trans.set_byte_enable_ptr(be);
+        trans.set_byte_enable_length(be_len);
+        trans.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
+
+        m_tester.p_bus.socket->b_transport(trans, delay);
+        m_delay = delay;
+
+        return trans.get_response_status();
+    }
+
+public:
+    SlaveTestBench(sc_core::sc_module_name n, ConfigManager &c)
+        : TestBench(n, c)
+        , m_slave("slave", c)
+        , m_tester("tester", c)
+    {
+        m_tester.connect_component(m_slave);
+    }
+};
+
+RABBITS_UNIT_TESTBENCH(access_64, SlaveTestBench)
+{
+    m_tester.bus_write_u64(0x8, 0x0123456789abcdefull);
+    RABBITS_TEST_ASSERT(m_tester.last_access_succeeded());
+    RABBITS_TEST_ASSERT_EQ(m_tester.bus_read_u64(0x8), 0x0123456789abcdefull);
+    RABBITS_TEST_ASSERT_EQ(m_tester.bus_read_u32(0xc), 0x01234567u);
+}
+
+RABBITS_UNIT_TESTBENCH(block_access, SlaveTestBench)
+{
+    uint8_t in[13], out[13];
+
+    for (unsigned int i = 0; i < sizeof(in); i++) {
+        in[i] = i + 1;
+    }
+
+    /* Split into naturally aligned accesses no wider than the bus */
+    m_tester.bus_write(0x2, in, sizeof(in));
+    RABBITS_TEST_ASSERT(m_tester.last_access_succeeded());
+
+    const std::vector<unsigned int> expected { 2, 4, 4, 2, 1 };
+    RABBITS_TEST_ASSERT(m_slave.m_sizes == expected);
+
+    m_tester.bus_read(0x2, out, sizeof(out));
+    RABBITS_TEST_ASSERT(m_tester.last_access_succeeded());
+    RABBITS_TEST_ASSERT(std::memcmp(in, out, sizeof(in)) == 0);
+
+    /* Crossing the end of the slave must fail */
+    m_tester.bus_write(0x3c, in, 5);
+    RABBITS_TEST_ASSERT(!m_tester.last_access_succeeded());
+}
+
+RABBITS_UNIT_TESTBENCH(streaming_width, SlaveTestBench)
+{
+    uint8_t data[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    uint8_t out[8];
+
+    /* Each beat is written at the same address, the last one wins */
+    RABBITS_TEST_ASSERT_EQ(transport(tlm::TLM_WRITE_COMMAND, 0x10, data, 8, 4),
+                           tlm::TLM_OK_RESPONSE);
+    RABBITS_TEST_ASSERT_EQ(m_slave.m_mem[0x10], 5);
+    RABBITS_TEST_ASSERT_EQ(m_slave.m_mem[0x13], 8);
+    RABBITS_TEST_ASSERT_EQ(m_slave.m_mem[0x14], 0);
+
+    RABBITS_TEST_ASSERT_EQ(transport(tlm::TLM_READ_COMMAND, 0x10, out, 8, 4),
+                           tlm::TLM_OK_RESPONSE);
+    RABBITS_TEST_ASSERT(std::memcmp(out, data + 4, 4) == 0);
+    RABBITS_TEST_ASSERT(std::memcmp(out + 4, data + 4, 4) == 0);
+}
+
+RABBITS_UNIT_TESTBENCH(byte_enable, SlaveTestBench)
+{
+    uint8_t data[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    uint8_t be[4] = { TLM_BYTE_ENABLED, TLM_BYTE_DISABLED,
+                      TLM_BYTE_ENABLED, TLM_BYTE_ENABLED };
+
+    /* The byte enable array is repeated over the data */
+    RABBITS_TEST_ASSERT_EQ(transport(tlm::TLM_WRITE_COMMAND, 0x20, data, 8, 8, be, 4),
+                           tlm::TLM_OK_RESPONSE);
+
+    const uint8_t expected[8] = { 1, 0, 3, 4, 5, 0, 7, 8 };
+    RABBITS_TEST_ASSERT(std::memcmp(m_slave.m_mem + 0x20, expected, 8) == 0);
+}
+
+RABBITS_UNIT_TESTBENCH(latencies, SlaveTestBench)
+{
+    const sc_core::sc_time ns(1, sc_core::SC_NS);
+    uint32_t data = 0;
+
+    RABBITS_TEST_ASSERT_EQ(transport(tlm::TLM_READ_COMMAND, 0, (uint8_t*) &data, 4, 4),
+                           tlm::TLM_OK_RESPONSE);
+    RABBITS_TEST_ASSERT_EQ(m_delay, sc_core::SC_ZERO_TIME);
+
+    m_slave.set_latencies(10 * ns, 20 * ns);
+    RABBITS_TEST_ASSERT(m_slave.add_range_latency(AddressRange(0x20, 0x10), 30 * ns, 40 * ns));
+    RABBITS_TEST_ASSERT(!m_slave.add_range_latency(AddressRange(0x28, 0x10), ns, ns));
+
+    transport(tlm::TLM_READ_COMMAND, 0x1c, (uint8_t*) &data, 4, 4);
+    RABBITS_TEST_ASSERT_EQ(m_delay, 10 * ns);
+    transport(tlm::TLM_WRITE_COMMAND, 0x1c, (uint8_t*) &data, 4, 4);
+    RABBITS_TEST_ASSERT_EQ(m_delay, 20 * ns);
+    transport(tlm::TLM_READ_COMMAND, 0x20, (uint8_t*) &data, 4, 4);
+    RABBITS_TEST_ASSERT_EQ(m_delay, 30 * ns);
+    transport(tlm::TLM_WRITE_COMMAND, 0x2c, (uint8_t*) &data, 4, 4);
+    RABBITS_TEST_ASSERT_EQ(m_delay, 40 * ns);
+}
+
+RABBITS_UNIT_TESTBENCH(initiator_info, SlaveTestBench)
+{
+    m_tester.bus_read_u32(0);
+    RABBITS_TEST_ASSERT(!m_slave.m_has_info);
+
+    TlmInitiatorInfo &info = m_tester.get_extension_slot<TlmInitiatorInfo>();
+    RABBITS_TEST_ASSERT(&info == &m_tester.get_extension_slot<TlmInitiatorInfo>());
+
+    info.set_id(3);
+    info.set_privilege(1);
+    info.set_type(TlmInitiatorInfo::INSTRUCTION);
+    m_tester.bus_read_u32(0);
+    RABBITS_TEST_ASSERT(m_slave.m_has_info);
+    RABBITS_TEST_ASSERT_EQ(m_slave.m_info.get_id(), 3u);
+    RABBITS_TEST_ASSERT_EQ(m_slave.m_info.get_privilege(), 1u);
+    RABBITS_TEST_ASSERT(m_slave.m_info.get_type() == TlmInitiatorInfo::INSTRUCTION);
+
+    /* Updated in place between accesses */
+    info.set_privilege(0);
+    m_tester.bus_write_u32(0, 0);
+    RABBITS_TEST_ASSERT_EQ(m_slave.m_info.get_privilege(), 0u);
+
+    /* Not visible outside of b_transport() */
+    RABBITS_TEST_ASSERT(m_slave.get_initiator_info() == nullptr);
+}
+
+RABBITS_UNIT_TESTBENCH(nb_transport, SlaveTestBench)
+{
+    uint32_t in[4] = { 0x11111111, 0x22222222, 0x33333333, 0x44444444 };
+    uint32_t out[4] = { 0 };
+
+    /* All the writes are in flight at the same time */
+    for (unsigned int i = 0; i < 4; i++) {
+        m_tester.nb_bus_write(0x10 + 4 * i, reinterpret_cast<uint8_t*>(in + i), 4);
+    }
+
+    RABBITS_TEST_ASSERT_EQ(m_tester.get_nb_outstanding(), 4u);
+    m_tester.wait_nb_outstanding();
+    RABBITS_TEST_ASSERT(std::memcmp(m_slave.m_mem + 0x10, in, sizeof(in)) == 0);
+
+    for (unsigned int i = 0; i < 4; i++) {
+        m_tester.nb_bus_read(0x10 + 4 * i, reinterpret_cast<uint8_t*>(out + i), 4);
+    }
+
+    m_tester.wait_nb_outstanding();
+    RABBITS_TEST_ASSERT(std::memcmp(in, out, sizeof(in)) == 0);
+
+    /* Errors are reported in the response */
+    tlm::tlm_generic_payload *trans =
+        m_tester.nb_bus_read(0x3e, reinterpret_cast<uint8_t*>(out), 4);
+    trans->acquire();
+    m_tester.wait_nb_outstanding();
+    RABBITS_TEST_ASSERT(trans->is_response_error());
+    trans->release();
+}
+
+RABBITS_UNIT_TESTBENCH(fast_slave, FastSlaveTestBench)
+{
+    uint32_t in[3] = { 1, 2, 3 }, out[3] = { 0 };
+
+    m_tester.bus_write_u32(0x4, 0xcafe);
+    RABBITS_TEST_ASSERT(m_tester.last_access_succeeded());
+    RABBITS_TEST_ASSERT_EQ(m_tester.bus_read_u32(0x4), 0xcafeu);
+
+    /* Inherited callbacks report a bus error */
+    m_tester.bus_read_u16(0x4);
+    RABBITS_TEST_ASSERT(!m_tester.last_access_succeeded());
+
+    /* Except the 64 bits ones, split into 32 bits accesses */
+    m_tester.bus_write_u64(0x8, 0x0123456789abcdefull);
+    RABBITS_TEST_ASSERT(m_tester.last_access_succeeded());
+    RABBITS_TEST_ASSERT_EQ(m_slave.m_regs[2], 0x89abcdefu);
+    RABBITS_TEST_ASSERT_EQ(m_slave.m_regs[3], 0x01234567u);
+    RABBITS_TEST_ASSERT_EQ(m_tester.bus_read_u64(0x8), 0x0123456789abcdefull);
+
+    /* Default block read is split into 32 bits accesses */
+    m_tester.bus_write(0, reinterpret_cast<uint8_t*>(in), sizeof(in));
+    RABBITS_TEST_ASSERT_EQ(m_slave.m_block_writes, 1u);
+    m_tester.bus_read(0, reinterpret_cast<uint8_t*>(out), sizeof(out));
+    RABBITS_TEST_ASSERT(m_tester.last_access_succeeded());
+    RABBITS_TEST_ASSERT(std::memcmp(in, out, sizeof(in)) == 0);
+}
+
+RABBITS_UNIT_TESTBENCH(write_combining, SlaveTestBench)
+{
+    const TlmPortStats &target = m_slave.p_bus.get_stats();
+
+    m_tester.p_bus.add_write_combining_range(AddressRange(0, 0x20));
+    m_tester.p_bus.set_write_combining(true);
+
+    /* Adjacent writes are buffered until a read */
+    for (unsigned int i = 0; i < 8; i++) {
+        m_tester.bus_write_u8(i, i + 1);
+    }
+
+    RABBITS_TEST_ASSERT_EQ(target.writes, 0u);
+    RABBITS_TEST_ASSERT_EQ(m_tester.bus_read_u8(7), 8);
+    RABBITS_TEST_ASSERT_EQ(target.writes, 1u);
+    RABBITS_TEST_ASSERT_EQ(target.write_bytes, 8u);
+
+    for (unsigned int i = 0; i < 8; i++) {
+        RABBITS_TEST_ASSERT_EQ(m_slave.m_mem[i], i + 1);
+    }
+
+    /* A non adjacent write flushes the buffer */
+    m_tester.bus_write_u32(0x10, 0x11111111);
+    m_tester.bus_write_u32(0x14, 0x22222222);
+    m_tester.bus_write_u32(0x0c, 0x33333333);
+    RABBITS_TEST_ASSERT_EQ(target.writes, 2u);
+
+    m_tester.flush_write_buffer();
+    RABBITS_TEST_ASSERT_EQ(target.writes, 3u);
+    RABBITS_TEST_ASSERT_EQ(m_tester.bus_read_u32(0x14), 0x22222222u);
+    RABBITS_TEST_ASSERT_EQ(m_tester.bus_read_u32(0x0c), 0x33333333u);
+
+    /* Writes outside of the combinable ranges go through right away */
+    m_tester.bus_write_u32(0x1e, 0x44444444);
+    RABBITS_TEST_ASSERT_EQ(target.writes, 4u);
+
+    RABBITS_TEST_ASSERT_EQ(m_tester.p_bus.get_stats().combined_writes, 11u);
+}
+
+RABBITS_UNIT_TESTBENCH(write_combining_errors, SlaveTestBench)
+{
+    const TlmPortStats &target = m_slave.p_bus.get_stats();
+
+    /* Goes past the end of the slave memory */
+    m_tester.p_bus.add_write_combining_range(AddressRange(0x30, 0x20));
+    m_tester.p_bus.set_write_combining(true);
+
+    /* Debug accesses see the buffered writes */
+    m_tester.bus_write_u32(0x30, 0xcafebabe);
+    RABBITS_TEST_ASSERT_EQ(target.writes, 0u);
+    RABBITS_TEST_ASSERT_EQ(m_tester.debug_read_u32_nofail(0x30), 0xcafebabeu);
+    RABBITS_TEST_ASSERT_EQ(target.writes, 1u);
+
+    /* A failed combined write is reported after the access flushing it */
+    m_tester.bus_write_u32(0x40, 1);
+    RABBITS_TEST_ASSERT(m_tester.last_access_succeeded());
+    RABBITS_TEST_ASSERT_EQ(m_tester.bus_read_u32(0), 0u);
+    RABBITS_TEST_ASSERT(m_tester.last_access_failed());
+    RABBITS_TEST_ASSERT(m_tester.last_access_failed());
+
+    /* Until the next access */
+    m_tester.bus_read_u32(0);
+    RABBITS_TEST_ASSERT(m_tester.last_access_succeeded());
+
+    m_tester.bus_write_u32(0x44, 1);
+    RABBITS_TEST_ASSERT(m_tester.flush_write_buffer().is_error());
+    RABBITS_TEST_ASSERT(m_tester.last_access_failed());
+
+    /* Debug accesses flush the buffer too */
+    m_tester.bus_write_u32(0x48, 1);
+    m_tester.debug_read_u32_nofail(0);
+    RABBITS_TEST_ASSERT(m_tester.last_access_failed());
+}
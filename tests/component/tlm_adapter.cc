@@ -0,0 +1,157 @@
+/*
+ *  This file is part of Rabbits
+ *  Copyright (C) 2017  Clement Deschamps and Luc Michel
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#define RABBITS_TEST_MOD tlm_adapter
+
+#include <cstring>
+
+#include <rabbits/test/test.h>
+#include <rabbits/component/master.h>
+#include <rabbits/component/memory_slave.h>
+
+#include "../../components/bus/tlm_adapter.h"
+
+template <unsigned int IN_BUSWIDTH, unsigned int OUT_BUSWIDTH, bool SWAP>
+class AdapterTestBench : public TestBench {
+protected:
+    Master<IN_BUSWIDTH> m_master;
+    TlmAdapter<IN_BUSWIDTH, OUT_BUSWIDTH, SWAP> m_adapter;
+    MemorySlave<OUT_BUSWIDTH> m_ram;
+
+    uint8_t * ram() { return m_ram.get_data(); }
+
+    bool failed() { return m_master.p_bus.get_last_access_status().is_error(); }
+
+    template <class T>
+    void write(uint64_t addr, T value)
+    {
+        m_master.bus_write(addr, reinterpret_cast<uint8_t*>(&value), sizeof(value));
+    }
+
+    template <class T>
+    T read(uint64_t addr)
+    {
+        T value = 0;
+        m_master.bus_read(addr, reinterpret_cast<uint8_t*>(&value), sizeof(value));
+        return value;
+    }
+
+public:
+    AdapterTestBench(sc_core::sc_module_name n, ConfigManager &c)
+        : TestBench(n, c)
+        , m_master("master", c)
+        , m_adapter("adapter", c)
+        , m_ram("ram", c, 0x100)
+    {
+        m_master.p_bus.connect(m_adapter.p_in);
+        m_adapter.p_out.connect(m_ram.p_bus);
+    }
+};
+
+typedef AdapterTestBench<64, 32, false> NarrowingTestBench;
+typedef AdapterTestBench<32, 32, true> SwapTestBench;
+
+RABBITS_UNIT_TESTBENCH(split, NarrowingTestBench)
+{
+    write<uint64_t>(0x10, 0x1122334455667788ull);
+    RABBITS_TEST_ASSERT(!failed());
+    RABBITS_TEST_ASSERT_EQ(m_ram.p_bus.get_stats().writes, 2u);
+    RABBITS_TEST_ASSERT_EQ(read<uint64_t>(0x10), 0x1122334455667788ull);
+    RABBITS_TEST_ASSERT_EQ(m_ram.p_bus.get_stats().reads, 2u);
+
+    /* Narrow accesses are not split */
+    write<uint32_t>(0x20, 0xcafebabe);
+    RABBITS_TEST_ASSERT_EQ(m_ram.p_bus.get_stats().writes, 3u);
+    RABBITS_TEST_ASSERT_EQ(*reinterpret_cast<uint32_t*>(ram() + 0x20), 0xcafebabeu);
+
+    /* An error on a chunk ends the access */
+    read<uint64_t>(0xfc);
+    RABBITS_TEST_ASSERT(failed());
+}
+
+RABBITS_UNIT_TESTBENCH(dmi_pass_through, NarrowingTestBench)
+{
+    DmiInfo info;
+
+    RABBITS_TEST_ASSERT(m_master.p_bus.dmi_probe(AddressRange(0x10, 4), info));
+    RABBITS_TEST_ASSERT(info.ptr == ram());
+    RABBITS_TEST_ASSERT_EQ(info.range.size(), 0x100u);
+}
+
+RABBITS_UNIT_TESTBENCH(swap, SwapTestBench)
+{
+    const uint8_t word[4] = { 0x11, 0x22, 0x33, 0x44 };
+    uint8_t data[4];
+
+    /* Whole words are byte reversed, the initiator data is left untouched */
+    std::memcpy(data, word, sizeof(data));
+    m_master.bus_write(0x10, data, sizeof(data));
+    RABBITS_TEST_ASSERT(!failed());
+    RABBITS_TEST_ASSERT(std::memcmp(data, word, sizeof(data)) == 0);
+
+    const uint8_t reversed[4] = { 0x44, 0x33, 0x22, 0x11 };
+    RABBITS_TEST_ASSERT(std::memcmp(ram() + 0x10, reversed, 4) == 0);
+
+    std::memset(data, 0, sizeof(data));
+    m_master.bus_read(0x10, data, sizeof(data));
+    RABBITS_TEST_ASSERT(std::memcmp(data, word, sizeof(data)) == 0);
+
+    /* Sub-word accesses are mirrored inside the word */
+    write<uint8_t>(0x21, 0xaa);
+    RABBITS_TEST_ASSERT_EQ(ram()[0x22], 0xaa);
+    RABBITS_TEST_ASSERT_EQ(read<uint8_t>(0x21), 0xaa);
+
+    data[0] = 0x55;
+    data[1] = 0x66;
+    m_master.bus_write(0x30, data, 2);
+    RABBITS_TEST_ASSERT_EQ(ram()[0x32], 0x66);
+    RABBITS_TEST_ASSERT_EQ(ram()[0x33], 0x55);
+}
+
+RABBITS_UNIT_TESTBENCH(swap_debug, SwapTestBench)
+{
+    const uint8_t image[6] = { 1, 2, 3, 4, 5, 6 };
+    uint8_t data[6] = { 0 };
+
+    /* Unaligned debug accesses are cut at the word boundaries */
+    RABBITS_TEST_ASSERT_EQ(m_master.p_bus.debug_write(0x41, image, sizeof(image)),
+                           sizeof(image));
+
+    const uint8_t head[3] = { 3, 2, 1 };
+    const uint8_t tail[3] = { 6, 5, 4 };
+    RABBITS_TEST_ASSERT(std::memcmp(ram() + 0x40, head, 3) == 0);
+    RABBITS_TEST_ASSERT(std::memcmp(ram() + 0x45, tail, 3) == 0);
+
+    RABBITS_TEST_ASSERT_EQ(m_master.p_bus.debug_read(0x41, data, sizeof(data)),
+                           sizeof(data));
+    RABBITS_TEST_ASSERT(std::memcmp(data, image, sizeof(data)) == 0);
+}
+
+RABBITS_UNIT_TESTBENCH(swap_dmi_refused, SwapTestBench)
+{
+    DmiInfo info;
+
+    RABBITS_TEST_ASSERT(!m_master.p_bus.dmi_probe(AddressRange(0x10, 4), info));
+
+    m_master.p_bus.set_dmi_enabled(true);
+    write<uint32_t>(0x10, 0x01020304);
+    RABBITS_TEST_ASSERT_EQ(ram()[0x10], 0x01);
+    RABBITS_TEST_ASSERT_EQ(read<uint32_t>(0x10), 0x01020304u);
+    RABBITS_TEST_ASSERT_EQ(m_master.p_bus.get_stats().dmi_accesses, 0u);
+}
@@ -0,0 +1,245 @@
+/*
+ *  This file is part of Rabbits
+ *  Copyright (C) 2017  Clement Deschamps and Luc Michel
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#define RABBITS_TEST_MOD tlm_initiator
+
+#include <tlm_utils/tlm_quantumkeeper.h>
+
+#include <rabbits/test/test.h>
+#include <rabbits/test/slave_tester.h>
+#include <rabbits/component/slave.h>
+#include <rabbits/datatypes/tlm_payload_pool.h>
+#include <rabbits/datatypes/dmi_cache.h>
+
+class ScratchSlave : public Slave<> {
+protected:
+    uint32_t m_reg = 0;
+
+public:
+    ScratchSlave(sc_core::sc_module_name n, ConfigManager &c)
+        : Slave(n, c) {}
+
+    void bus_cb_read_32(uint64_t addr, uint32_t *value, bool &bErr)
+    {
+        *value = m_reg;
+    }
+
+    void bus_cb_write_32(uint64_t addr, uint32_t *value, bool &bErr)
+    {
+        m_reg = *value;
+    }
+};
+
+class TlmInitiatorTestBench : public TestBench {
+protected:
+    ScratchSlave m_slave;
+    SlaveTester<> m_tester;
+
+public:
+    TlmInitiatorTestBench(sc_core::sc_module_name n, ConfigManager &c)
+        : TestBench(n, c)
+        , m_slave("slave", c)
+        , m_tester("tester", c)
+    {
+        m_tester.connect_component(m_slave);
+    }
+};
+
+/* Annotates a fixed delay on each access instead of waiting for it */
+class TimedSlave : public ScratchSlave {
+public:
+    TimedSlave(sc_core::sc_module_name n, ConfigManager &c)
+        : ScratchSlave(n, c) {}
+
+    void b_transport(tlm::tlm_generic_payload& trans, sc_core::sc_time& delay)
+    {
+        ScratchSlave::b_transport(trans, delay);
+        delay += sc_core::sc_time(10, sc_core::SC_NS);
+    }
+};
+
+class DecouplingTestBench : public TestBench {
+protected:
+    TimedSlave m_slave;
+    SlaveTester<> m_tester;
+
+public:
+    DecouplingTestBench(sc_core::sc_module_name n, ConfigManager &c)
+        : TestBench(n, c)
+        , m_slave("slave", c)
+        , m_tester("tester", c)
+    {
+        tlm_utils::tlm_quantumkeeper::set_global_quantum(sc_core::sc_time(100, sc_core::SC_NS));
+        m_tester.connect_component(m_slave);
+    }
+};
+
+RABBITS_UNIT_TEST(payload_pool_reuse)
+{
+    TlmPayloadPool pool;
+
+    tlm::tlm_generic_payload *t0 = pool.acquire();
+    tlm::tlm_generic_payload *t1 = pool.acquire();
+
+    RABBITS_TEST_ASSERT(t0 != t1);
+    RABBITS_TEST_ASSERT_EQ(pool.size(), 2u);
+    RABBITS_TEST_ASSERT_EQ(pool.available(), 0u);
+
+    pool.release(t1);
+    RABBITS_TEST_ASSERT_EQ(pool.available(), 1u);
+
+    /* A payload still referenced elsewhere must not go back to the pool */
+    t0->acquire();
+    pool.release(t0);
+    RABBITS_TEST_ASSERT_EQ(pool.available(), 1u);
+    t0->release();
+    RABBITS_TEST_ASSERT_EQ(pool.available(), 2u);
+
+    RABBITS_TEST_ASSERT(pool.acquire() == t0);
+    RABBITS_TEST_ASSERT(pool.acquire() == t1);
+    RABBITS_TEST_ASSERT_EQ(pool.size(), 2u);
+}
+
+RABBITS_UNIT_TEST(dmi_cache)
+{
+    static uint8_t mem[0x100];
+    DmiCache cache;
+    DmiInfo info;
+
+    info.ptr = mem;
+    info.range = AddressRange(0x1000, sizeof(mem));
+    info.read_allowed = true;
+    info.write_allowed = false;
+    cache.insert(info);
+
+    RABBITS_TEST_ASSERT(cache.lookup(0x1000, 4, false) != nullptr);
+    RABBITS_TEST_ASSERT(cache.lookup(0x10fc, 4, false) != nullptr);
+    RABBITS_TEST_ASSERT(cache.lookup(0x10fe, 4, false) == nullptr);
+    RABBITS_TEST_ASSERT(cache.lookup(0x0ffe, 4, false) == nullptr);
+    RABBITS_TEST_ASSERT(cache.lookup(0x1000, 4, true) == nullptr);
+
+    /* Punch a hole in the middle of the region */
+    cache.invalidate(0x1040, 0x107f);
+    RABBITS_TEST_ASSERT_EQ(cache.size(), 2u);
+    RABBITS_TEST_ASSERT(cache.lookup(0x1040, 4, false) == nullptr);
+    RABBITS_TEST_ASSERT(cache.lookup(0x103c, 8, false) == nullptr);
+
+    const DmiInfo *upper = cache.lookup(0x1080, 4, false);
+    RABBITS_TEST_ASSERT(upper != nullptr);
+    RABBITS_TEST_ASSERT(upper->ptr == mem + 0x80);
+    RABBITS_TEST_ASSERT_EQ(upper->range.end(), 0x10ffu);
+
+    const DmiInfo *lower = cache.lookup(0x103c, 4, false);
+    RABBITS_TEST_ASSERT(lower != nullptr);
+    RABBITS_TEST_ASSERT(lower->ptr == mem);
+    RABBITS_TEST_ASSERT_EQ(lower->range.end(), 0x103fu);
+
+    cache.clear();
+    RABBITS_TEST_ASSERT(cache.empty());
+}
+
+RABBITS_UNIT_TESTBENCH(bus_access, TlmInitiatorTestBench)
+{
+    m_tester.bus_write_u32(0, 0xdeadbeef);
+    RABBITS_TEST_ASSERT(m_tester.last_access_succeeded());
+    RABBITS_TEST_ASSERT_EQ(m_tester.bus_read_u32(0), 0xdeadbeef);
+
+    for (int i = 0; i < 16; i++) {
+        m_tester.bus_write_u32(0, i);
+        RABBITS_TEST_ASSERT_EQ(m_tester.bus_read_u32(0), uint32_t(i));
+    }
+}
+
+RABBITS_UNIT_TESTBENCH(bus_access_v, TlmInitiatorTestBench)
+{
+    uint32_t w0 = 0x11111111, w1 = 0x22222222, r0 = 0, r1 = 0;
+    uint16_t h = 0;
+
+    BusAccessDescriptor wr[] = {
+        BusAccessDescriptor(0, reinterpret_cast<uint8_t*>(&w0), sizeof(w0)),
+        BusAccessDescriptor(4, reinterpret_cast<uint8_t*>(&w1), sizeof(w1)),
+    };
+
+    RABBITS_TEST_ASSERT_EQ(m_tester.bus_write_v(wr, 2), 2u);
+    RABBITS_TEST_ASSERT(!wr[0].status.is_error());
+    RABBITS_TEST_ASSERT(!wr[1].status.is_error());
+
+    /* The scratch slave only handles 32 bits accesses */
+    BusAccessDescriptor rd[] = {
+        BusAccessDescriptor(0, reinterpret_cast<uint8_t*>(&r0), sizeof(r0)),
+        BusAccessDescriptor(0, reinterpret_cast<uint8_t*>(&h), sizeof(h)),
+        BusAccessDescriptor(0, reinterpret_cast<uint8_t*>(&r1), sizeof(r1)),
+    };
+
+    RABBITS_TEST_ASSERT_EQ(m_tester.bus_read_v(rd, 3), 2u);
+    RABBITS_TEST_ASSERT(!rd[0].status.is_error());
+    RABBITS_TEST_ASSERT(rd[1].status.is_error());
+    RABBITS_TEST_ASSERT(!rd[2].status.is_error());
+    RABBITS_TEST_ASSERT_EQ(r0, 0x22222222u);
+    RABBITS_TEST_ASSERT_EQ(r1, 0x22222222u);
+    RABBITS_TEST_ASSERT(!m_tester.last_access_succeeded());
+
+    const TlmPortStats &stats = m_tester.p_bus.get_stats();
+    RABBITS_TEST_ASSERT_EQ(stats.socket_accesses, 5u);
+    RABBITS_TEST_ASSERT_EQ(stats.errors, 1u);
+}
+
+RABBITS_UNIT_TESTBENCH(temporal_decoupling, DecouplingTestBench)
+{
+    const sc_core::sc_time start = sc_core::sc_time_stamp();
+
+    for (int i = 0; i < 9; i++) {
+        m_tester.bus_write_u32(0, i);
+    }
+
+    /* Annotated delays are accumulated without synchronizing */
+    RABBITS_TEST_ASSERT_EQ(sc_core::sc_time_stamp(), start);
+    RABBITS_TEST_ASSERT_EQ(m_tester.p_bus.get_local_time(), sc_core::sc_time(90, sc_core::SC_NS));
+
+    /* Reaching the quantum triggers a synchronization */
+    m_tester.bus_read_u32(0);
+    RABBITS_TEST_ASSERT_EQ(sc_core::sc_time_stamp(), start + sc_core::sc_time(100, sc_core::SC_NS));
+    RABBITS_TEST_ASSERT_EQ(m_tester.p_bus.get_local_time(), sc_core::SC_ZERO_TIME);
+
+    m_tester.bus_read_u32(0);
+    m_tester.p_bus.sync();
+    RABBITS_TEST_ASSERT_EQ(sc_core::sc_time_stamp(), start + sc_core::sc_time(110, sc_core::SC_NS));
+}
+
+RABBITS_UNIT_TESTBENCH(stats, TlmInitiatorTestBench)
+{
+    m_tester.bus_write_u32(0, 1);
+    m_tester.bus_write_u32(0, 2);
+    m_tester.bus_read_u32(0);
+    m_tester.bus_read_u16(0);
+
+    const TlmPortStats &init = m_tester.p_bus.get_stats();
+    RABBITS_TEST_ASSERT_EQ(init.writes, 2u);
+    RABBITS_TEST_ASSERT_EQ(init.write_bytes, 8u);
+    RABBITS_TEST_ASSERT_EQ(init.reads, 2u);
+    RABBITS_TEST_ASSERT_EQ(init.read_bytes, 6u);
+    RABBITS_TEST_ASSERT_EQ(init.errors, 1u);
+    RABBITS_TEST_ASSERT_EQ(init.socket_accesses, 4u);
+    RABBITS_TEST_ASSERT_EQ(init.dmi_accesses, 0u);
+    RABBITS_TEST_ASSERT_EQ(init.latencies[0], 4u);
+
+    const TlmPortStats &target = m_slave.p_bus.get_stats();
+    RABBITS_TEST_ASSERT_EQ(target.accesses(), 4u);
+    RABBITS_TEST_ASSERT_EQ(target.errors, 1u);
+}
@@ -0,0 +1,74 @@
+/*
+ *  This file is part of Rabbits
+ *  Copyright (C) 2017  Clement Deschamps and Luc Michel
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#define RABBITS_TEST_MOD tlm_replayer
+
+#include <cstdio>
+
+#include <rabbits/test/test.h>
+#include <rabbits/test/tlm_replayer.h>
+#include <rabbits/component/memory_slave.h>
+
+class ReplayTestBench : public TestBench {
+protected:
+    MemorySlave<> m_ram;
+    TlmReplayer<> m_replayer;
+
+    static void record(TlmRecorder &r, tlm::tlm_command cmd, uint64_t addr,
+                       uint32_t value, tlm::tlm_response_status status)
+    {
+        tlm::tlm_generic_payload trans;
+
+        trans.set_command(cmd);
+        trans.set_address(addr);
+        trans.set_data_ptr(reinterpret_cast<uint8_t*>(&value));
+        trans.set_data_length(sizeof(value));
+        trans.set_response_status(status);
+
+        r.record(trans, sc_core::SC_ZERO_TIME);
+    }
+
+public:
+    ReplayTestBench(sc_core::sc_module_name n, ConfigManager &c)
+        : TestBench(n, c)
+        , m_ram("ram", c, 0x100)
+        , m_replayer("replayer", c)
+    {
+        m_replayer.connect_component(m_ram);
+    }
+};
+
+RABBITS_UNIT_TESTBENCH(replay, ReplayTestBench)
+{
+    const char *fn = "tlm_replayer_test.tlmrec";
+    TlmRecorder recorder;
+
+    RABBITS_TEST_ASSERT(recorder.open(fn));
+    record(recorder, tlm::TLM_WRITE_COMMAND, 0x10, 0x12345678, tlm::TLM_OK_RESPONSE);
+    record(recorder, tlm::TLM_READ_COMMAND, 0x10, 0x12345678, tlm::TLM_OK_RESPONSE);
+    record(recorder, tlm::TLM_READ_COMMAND, 0x200, 0, tlm::TLM_ADDRESS_ERROR_RESPONSE);
+    RABBITS_TEST_ASSERT_EQ(recorder.get_count(), 3u);
+    recorder.close();
+
+    RABBITS_TEST_ASSERT_EQ(m_replayer.replay(fn, true), 3u);
+    RABBITS_TEST_ASSERT_EQ(m_replayer.get_mismatches(), 0u);
+    RABBITS_TEST_ASSERT_EQ(*reinterpret_cast<uint32_t*>(m_ram.get_data() + 0x10), 0x12345678u);
+
+    std::remove(fn);
+}
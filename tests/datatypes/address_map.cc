@@ -0,0 +1,58 @@
+/*
+ *  This file is part of Rabbits
+ *  Copyright (C) 2017  Clement Deschamps and Luc Michel
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#define RABBITS_TEST_MOD address_map
+
+#include <rabbits/test/test.h>
+#include <rabbits/datatypes/address_map.h>
+
+RABBITS_UNIT_TEST(lookup)
+{
+    AddressMap<int> map;
+
+    RABBITS_TEST_ASSERT(map.insert(AddressRange(0x1000, 0x1000), 1));
+    RABBITS_TEST_ASSERT(map.insert(AddressRange(0x0, 0x100), 0));
+    RABBITS_TEST_ASSERT(map.insert(AddressRange(0x3000, 0x10), 2));
+
+    /* Overlaps and empty ranges are rejected */
+    RABBITS_TEST_ASSERT(!map.insert(AddressRange(0x1fff, 0x10), 3));
+    RABBITS_TEST_ASSERT(!map.insert(AddressRange(0xf00, 0x101), 3));
+    RABBITS_TEST_ASSERT(!map.insert(AddressRange(0x2000, 0), 3));
+    RABBITS_TEST_ASSERT_EQ(map.size(), 3u);
+
+    RABBITS_TEST_ASSERT_EQ(map.lookup(0x0)->value, 0);
+    RABBITS_TEST_ASSERT_EQ(map.lookup(0xff)->value, 0);
+    RABBITS_TEST_ASSERT(map.lookup(0x100) == nullptr);
+    RABBITS_TEST_ASSERT_EQ(map.lookup(0x1800)->value, 1);
+    RABBITS_TEST_ASSERT_EQ(map.lookup(0x1fff)->value, 1);
+    RABBITS_TEST_ASSERT(map.lookup(0x2000) == nullptr);
+    RABBITS_TEST_ASSERT_EQ(map.lookup(0x300f)->value, 2);
+    RABBITS_TEST_ASSERT(map.lookup(0x3010) == nullptr);
+
+    /* Entries are sorted */
+    uint64_t prev = 0;
+    for (const AddressMap<int>::Entry &e : map) {
+        RABBITS_TEST_ASSERT_GE(e.range.begin(), prev);
+        prev = e.range.begin();
+    }
+
+    RABBITS_TEST_ASSERT_EQ(map.lower_bound(0x1004)->value, 1);
+    RABBITS_TEST_ASSERT_EQ(map.lower_bound(0x2000)->value, 2);
+    RABBITS_TEST_ASSERT(map.lower_bound(0x4000) == map.end());
+}
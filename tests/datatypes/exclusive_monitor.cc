@@ -0,0 +1,66 @@
+/*
+ *  This file is part of Rabbits
+ *  Copyright (C) 2017  Clement Deschamps and Luc Michel
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#define RABBITS_TEST_MOD exclusive_monitor
+
+#include <rabbits/test/test.h>
+#include <rabbits/datatypes/exclusive_monitor.h>
+
+static const int cpu0 = 0, cpu1 = 1;
+
+RABBITS_UNIT_TEST(reservation)
+{
+    ExclusiveMonitor m(16);
+
+    /* Reservations are granule wide */
+    AddressRange r = m.reserve(&cpu0, 0x104);
+    RABBITS_TEST_ASSERT_EQ(r.begin(), 0x100u);
+    RABBITS_TEST_ASSERT_EQ(r.size(), 16u);
+    RABBITS_TEST_ASSERT(m.store_exclusive(&cpu0, 0x10c, 4));
+    RABBITS_TEST_ASSERT(!m.store_exclusive(&cpu0, 0x10c, 4));
+
+    /* Only the first successful store wins */
+    m.reserve(&cpu0, 0x100);
+    m.reserve(&cpu1, 0x108);
+    RABBITS_TEST_ASSERT(m.store_exclusive(&cpu1, 0x108, 4));
+    RABBITS_TEST_ASSERT(!m.store_exclusive(&cpu0, 0x100, 4));
+
+    /* Plain writes break overlapping reservations only */
+    m.reserve(&cpu0, 0x100);
+    m.reserve(&cpu1, 0x200);
+    RABBITS_TEST_ASSERT(m.write(0x0fe, 4));
+    RABBITS_TEST_ASSERT(!m.write(0x1f0, 4));
+    RABBITS_TEST_ASSERT(!m.store_exclusive(&cpu0, 0x100, 4));
+    RABBITS_TEST_ASSERT(m.store_exclusive(&cpu1, 0x200, 4));
+    RABBITS_TEST_ASSERT(m.empty());
+}
+
+RABBITS_UNIT_TEST(clamp)
+{
+    ExclusiveMonitor m(16);
+    uint64_t start = 0, end = 0xfff;
+
+    m.reserve(&cpu0, 0x100);
+    m.reserve(&cpu1, 0x400);
+
+    RABBITS_TEST_ASSERT(!m.clamp(0x10c, start, end));
+    RABBITS_TEST_ASSERT(m.clamp(0x200, start, end));
+    RABBITS_TEST_ASSERT_EQ(start, 0x110u);
+    RABBITS_TEST_ASSERT_EQ(end, 0x3ffu);
+}
@@ -0,0 +1,55 @@
+/*
+ *  This file is part of Rabbits
+ *  Copyright (C) 2017  Clement Deschamps and Luc Michel
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#define RABBITS_TEST_MOD register_profiler
+
+#include <rabbits/test/test.h>
+#include <rabbits/datatypes/register_profiler.h>
+
+RABBITS_UNIT_TEST(top)
+{
+    RegisterProfiler p;
+    std::vector<RegisterProfiler::Entry> top;
+
+    /* Enough distinct offsets to grow the table a few times */
+    for (uint64_t off = 0; off < 0x1000; off += 4) {
+        p.record(off, true);
+    }
+
+    for (int i = 0; i < 100; i++) {
+        p.record(0x10, false);
+    }
+
+    for (int i = 0; i < 50; i++) {
+        p.record(0x800, i & 1);
+    }
+
+    RABBITS_TEST_ASSERT_EQ(p.size(), 0x400u);
+
+    p.top(2, top);
+    RABBITS_TEST_ASSERT_EQ(top.size(), 2u);
+    RABBITS_TEST_ASSERT_EQ(top[0].offset, 0x10u);
+    RABBITS_TEST_ASSERT_EQ(top[0].reads, 100u);
+    RABBITS_TEST_ASSERT_EQ(top[0].writes, 1u);
+    RABBITS_TEST_ASSERT_EQ(top[1].offset, 0x800u);
+    RABBITS_TEST_ASSERT_EQ(top[1].writes, 26u);
+
+    p.reset();
+    RABBITS_TEST_ASSERT_EQ(p.size(), 0u);
+}
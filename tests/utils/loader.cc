@@ -0,0 +1,329 @@
+/*
+ *  This file is part of Rabbits
+ *  Copyright (C) 2017  Clement Deschamps and Luc Michel
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License
+ *  as published by the Free Software Foundation; either version 2
+ *  of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#define RABBITS_TEST_MOD loader
+
+#include <elf.h>
+
+#include <cstring>
+#include <vector>
+
+#include <rabbits/config.h>
+#include <rabbits/test/test.h>
+#include <rabbits/component/memory_slave.h>
+#include <rabbits/component/debug_initiator.h>
+#include <rabbits/utils/loader/loader.h>
+
+/* gzip compression of the IMAGE_SIZE bytes generated by image_byte() */
+static const uint8_t GZIP_IMAGE[] = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x63, 0x60,
+    0xe7, 0x13, 0x95, 0x51, 0xd6, 0x32, 0xb4, 0xb0, 0x77, 0xf3, 0x0d, 0x89,
+    0x4e, 0xca, 0x2c, 0x28, 0xaf, 0x6b, 0xed, 0x99, 0x3c, 0x6b, 0xe1, 0x8a,
+    0xf5, 0xdb, 0xf6, 0x1e, 0x39, 0x7d, 0xe9, 0xe6, 0x83, 0xe7, 0xef, 0xbe,
+    0xfe, 0x61, 0xe6, 0x12, 0x94, 0x90, 0x57, 0xd3, 0x35, 0xb1, 0x76, 0xf2,
+    0x0c, 0x08, 0x8f, 0x4b, 0xcd, 0x29, 0xae, 0x6a, 0xec, 0xe8, 0x9f, 0x36,
+    0x77, 0xc9, 0xea, 0x4d, 0x3b, 0x0f, 0x1c, 0x3f, 0x77, 0xf5, 0xce, 0xe3,
+    0x57, 0x1f, 0x7f, 0xfc, 0x67, 0xe3, 0x15, 0x91, 0x56, 0xd2, 0x34, 0x30,
+    0xb7, 0x73, 0xf5, 0x09, 0x8e, 0x4a, 0xcc, 0xc8, 0x2f, 0xab, 0x6d, 0xe9,
+    0x9e, 0x34, 0x73, 0xc1, 0xf2, 0x75, 0x5b, 0xf7, 0x1c, 0x3e, 0x75, 0xf1,
+    0xc6, 0xfd, 0x67, 0x6f, 0xbf, 0xfc, 0x66, 0xe2, 0x14, 0x10, 0x97, 0x53,
+    0xd5, 0x31, 0xb6, 0x72, 0xf4, 0xf0, 0x0f, 0x8b, 0x4d, 0xc9, 0x2e, 0xaa,
+    0x6c, 0x68, 0xef, 0x9b, 0x3a, 0x67, 0xf1, 0xaa, 0x8d, 0x3b, 0xf6, 0x1f,
+    0x3b, 0x7b, 0xe5, 0xf6, 0xa3, 0x97, 0x1f, 0xbe, 0xff, 0x63, 0xe5, 0x11,
+    0x96, 0x52, 0xd4, 0xd0, 0x37, 0xb3, 0x75, 0xf1, 0x0e, 0x8a, 0x4c, 0x48,
+    0xcf, 0x2b, 0xad, 0x69, 0xee, 0x9a, 0x38, 0x63, 0xfe, 0xb2, 0xb5, 0x5b,
+    0x76, 0x1f, 0x3a, 0x79, 0xe1, 0xfa, 0xbd, 0xa7, 0x6f, 0x3e, 0xff, 0x62,
+    0xe4, 0xe0, 0x17, 0x93, 0x55, 0xd1, 0x36, 0xb2, 0x74, 0x70, 0xf7, 0x0b,
+    0x8d, 0x49, 0xce, 0x2a, 0xac, 0xa8, 0x6f, 0xeb, 0x9d, 0x32, 0x7b, 0xd1,
+    0xca, 0x0d, 0xdb, 0xf7, 0x1d, 0x3d, 0x73, 0xf9, 0xd6, 0xc3, 0x17, 0xef,
+    0xbf, 0xfd, 0x65, 0xe1, 0x16, 0x92, 0x54, 0x50, 0xd7, 0x33, 0xb5, 0x71,
+    0xf6, 0x0a, 0x8c, 0x88, 0x4f, 0xcb, 0x2d, 0xa9, 0x6e, 0xea, 0x9c, 0x30,
+    0x7d, 0xde, 0xd2, 0x35, 0x9b, 0x77, 0x1d, 0x3c, 0x71, 0xfe, 0xda, 0xdd,
+    0x27, 0xaf, 0x3f, 0xfd, 0xa4, 0x9a, 0x41, 0x0c, 0x43, 0x33, 0x20, 0x07,
+    0x5f, 0x8c, 0xd0, 0x37, 0x20, 0x87, 0x71, 0xd2, 0x26, 0x2a, 0x20, 0x87,
+    0x71, 0xd2, 0x26, 0x2a, 0x20, 0x87, 0x71, 0xd2, 0x26, 0x2a, 0x20, 0x87,
+    0x71, 0xd2, 0x26, 0x2a, 0x20, 0x47, 0x78, 0xf5, 0xc7, 0x30, 0xc2, 0xab,
+    0x3f, 0xc6, 0x11, 0x5e, 0xfd, 0x31, 0x8d, 0xf0, 0xea, 0x8f, 0x79, 0x84,
+    0x57, 0x7f, 0x2c, 0x23, 0xbc, 0xfa, 0x63, 0x1d, 0xe1, 0xd5, 0x1f, 0xdb,
+    0x08, 0xaf, 0xfe, 0xd8, 0x47, 0x78, 0xf5, 0xc7, 0x01, 0x00, 0x21, 0x1e,
+    0x2c, 0x46, 0x00, 0x10, 0x00, 0x00,
+};
+
+/* zstd compression of the same image */
+static const uint8_t ZSTD_IMAGE[] = {
+    0x28, 0xb5, 0x2f, 0xfd, 0x60, 0x00, 0x0f, 0xad, 0x09, 0x00, 0x04, 0x10,
+    0x00, 0x07, 0x0e, 0x15, 0x1c, 0x23, 0x2a, 0x31, 0x38, 0x3f, 0x46, 0x4d,
+    0x54, 0x5b, 0x62, 0x69, 0x70, 0x77, 0x7e, 0x85, 0x8c, 0x93, 0x9a, 0xa1,
+    0xa8, 0xaf, 0xb6, 0xbd, 0xc4, 0xcb, 0xd2, 0xd9, 0xe0, 0xe7, 0xee, 0xf5,
+    0xfc, 0x03, 0x0a, 0x11, 0x18, 0x1f, 0x26, 0x2d, 0x34, 0x3b, 0x42, 0x49,
+    0x50, 0x57, 0x5e, 0x65, 0x6c, 0x73, 0x7a, 0x81, 0x88, 0x8f, 0x96, 0x9d,
+    0xa4, 0xab, 0xb2, 0xb9, 0xc0, 0xc7, 0xce, 0xd5, 0xdc, 0xe3, 0xea, 0xf1,
+    0xf8, 0xff, 0x06, 0x0d, 0x14, 0x1b, 0x22, 0x29, 0x30, 0x37, 0x3e, 0x45,
+    0x4c, 0x53, 0x5a, 0x61, 0x68, 0x6f, 0x76, 0x7d, 0x84, 0x8b, 0x92, 0x99,
+    0xa0, 0xa7, 0xae, 0xb5, 0xbc, 0xc3, 0xca, 0xd1, 0xd8, 0xdf, 0xe6, 0xed,
+    0xf4, 0xfb, 0x02, 0x09, 0x10, 0x17, 0x1e, 0x25, 0x2c, 0x33, 0x3a, 0x41,
+    0x48, 0x4f, 0x56, 0x5d, 0x64, 0x6b, 0x72, 0x79, 0x80, 0x87, 0x8e, 0x95,
+    0x9c, 0xa3, 0xaa, 0xb1, 0xb8, 0xbf, 0xc6, 0xcd, 0xd4, 0xdb, 0xe2, 0xe9,
+    0xf0, 0xf7, 0xfe, 0x05, 0x0c, 0x13, 0x1a, 0x21, 0x28, 0x2f, 0x36, 0x3d,
+    0x44, 0x4b, 0x52, 0x59, 0x60, 0x67, 0x6e, 0x75, 0x7c, 0x83, 0x8a, 0x91,
+    0x98, 0x9f, 0xa6, 0xad, 0xb4, 0xbb, 0xc2, 0xc9, 0xd0, 0xd7, 0xde, 0xe5,
+    0xec, 0xf3, 0xfa, 0x01, 0x08, 0x0f, 0x16, 0x1d, 0x24, 0x2b, 0x32, 0x39,
+    0x40, 0x47, 0x4e, 0x55, 0x5c, 0x63, 0x6a, 0x71, 0x78, 0x7f, 0x86, 0x8d,
+    0x94, 0x9b, 0xa2, 0xa9, 0xb0, 0xb7, 0xbe, 0xc5, 0xcc, 0xd3, 0xda, 0xe1,
+    0xe8, 0xef, 0xf6, 0xfd, 0x04, 0x0b, 0x12, 0x19, 0x20, 0x27, 0x2e, 0x35,
+    0x3c, 0x43, 0x4a, 0x51, 0x58, 0x5f, 0x66, 0x6d, 0x74, 0x7b, 0x82, 0x89,
+    0x90, 0x97, 0x9e, 0xa5, 0xac, 0xb3, 0xba, 0xc1, 0xc8, 0xcf, 0xd6, 0xdd,
+    0xe4, 0xeb, 0xf2, 0xf9, 0x1e, 0xa8, 0xe0, 0xf7, 0xff, 0xdf, 0xe0, 0x75,
+    0x86, 0x35, 0x10, 0xfe, 0xff, 0x3f, 0x11, 0x9e, 0x18, 0x7d, 0x5a, 0x93,
+    0x0d, 0x68, 0x2c, 0x0d, 0x43, 0x6b, 0x68, 0x2c, 0x8d, 0xa5, 0x6d, 0x69,
+    0x2c, 0x5a, 0x43, 0x6b, 0xa0, 0x35, 0xb4, 0x86, 0xc6, 0xd2, 0x98, 0x4f,
+    0x63, 0x92, 0x11, 0x80, 0x31, 0x79, 0xa7,
+};
+
+/*
+ * gzip compression of an ELF32 image, entry point at 0x2010, with one
+ * PT_LOAD segment at 0x2000 holding the first 0x100 bytes generated by
+ * image_byte(), followed by 0x100 bytes of bss.
+ */
+static const uint8_t GZIP_ELF_IMAGE[] = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xab, 0x77,
+    0xf5, 0x71, 0x63, 0x64, 0x64, 0x64, 0x80, 0x01, 0x26, 0x06, 0x0d, 0x06,
+    0x10, 0x4f, 0x40, 0x81, 0x81, 0xc1, 0x84, 0x01, 0x01, 0x4c, 0x18, 0x14,
+    0x80, 0xe2, 0x1a, 0x60, 0x36, 0x48, 0x3e, 0x04, 0xc4, 0x50, 0x80, 0x62,
+    0x46, 0xb0, 0x46, 0x06, 0x76, 0x20, 0xc5, 0x02, 0x12, 0x67, 0xe7, 0x13,
+    0x95, 0x51, 0xd6, 0x32, 0xb4, 0xb0, 0x77, 0xf3, 0x0d, 0x89, 0x4e, 0xca,
+    0x2c, 0x28, 0xaf, 0x6b, 0xed, 0x99, 0x3c, 0x6b, 0xe1, 0x8a, 0xf5, 0xdb,
+    0xf6, 0x1e, 0x39, 0x7d, 0xe9, 0xe6, 0x83, 0xe7, 0xef, 0xbe, 0xfe, 0x61,
+    0xe6, 0x12, 0x94, 0x90, 0x57, 0xd3, 0x35, 0xb1, 0x76, 0xf2, 0x0c, 0x08,
+    0x8f, 0x4b, 0xcd, 0x29, 0xae, 0x6a, 0xec, 0xe8, 0x9f, 0x36, 0x77, 0xc9,
+    0xea, 0x4d, 0x3b, 0x0f, 0x1c, 0x3f, 0x77, 0xf5, 0xce, 0xe3, 0x57, 0x1f,
+    0x7f, 0xfc, 0x67, 0xe3, 0x15, 0x91, 0x56, 0xd2, 0x34, 0x30, 0xb7, 0x73,
+    0xf5, 0x09, 0x8e, 0x4a, 0xcc, 0xc8, 0x2f, 0xab, 0x6d, 0xe9, 0x9e, 0x34,
+    0x73, 0xc1, 0xf2, 0x75, 0x5b, 0xf7, 0x1c, 0x3e, 0x75, 0xf1, 0xc6, 0xfd,
+    0x67, 0x6f, 0xbf, 0xfc, 0x66, 0xe2, 0x14, 0x10, 0x97, 0x53, 0xd5, 0x31,
+    0xb6, 0x72, 0xf4, 0xf0, 0x0f, 0x8b, 0x4d, 0xc9, 0x2e, 0xaa, 0x6c, 0x68,
+    0xef, 0x9b, 0x3a, 0x67, 0xf1, 0xaa, 0x8d, 0x3b, 0xf6, 0x1f, 0x3b, 0x7b,
+    0xe5, 0xf6, 0xa3, 0x97, 0x1f, 0xbe, 0xff, 0x63, 0xe5, 0x11, 0x96, 0x52,
+    0xd4, 0xd0, 0x37, 0xb3, 0x75, 0xf1, 0x0e, 0x8a, 0x4c, 0x48, 0xcf, 0x2b,
+    0xad, 0x69, 0xee, 0x9a, 0x38, 0x63, 0xfe, 0xb2, 0xb5, 0x5b, 0x76, 0x1f,
+    0x3a, 0x79, 0xe1, 0xfa, 0xbd, 0xa7, 0x6f, 0x3e, 0xff, 0x62, 0xe4, 0xe0,
+    0x17, 0x93, 0x55, 0xd1, 0x36, 0xb2, 0x74, 0x70, 0xf7, 0x0b, 0x8d, 0x49,
+    0xce, 0x2a, 0xac, 0xa8, 0x6f, 0xeb, 0x9d, 0x32, 0x7b, 0xd1, 0xca, 0x0d,
+    0xdb, 0xf7, 0x1d, 0x3d, 0x73, 0xf9, 0xd6, 0xc3, 0x17, 0xef, 0xbf, 0xfd,
+    0x65, 0xe1, 0x16, 0x92, 0x54, 0x50, 0xd7, 0x33, 0xb5, 0x71, 0xf6, 0x0a,
+    0x8c, 0x88, 0x4f, 0xcb, 0x2d, 0xa9, 0x6e, 0xea, 0x9c, 0x30, 0x7d, 0xde,
+    0xd2, 0x35, 0x9b, 0x77, 0x1d, 0x3c, 0x71, 0xfe, 0xda, 0xdd, 0x27, 0xaf,
+    0x3f, 0xfd, 0x04, 0x00, 0xa0, 0xdd, 0xaf, 0x36, 0x54, 0x01, 0x00, 0x00,
+};
+
+static const size_t IMAGE_SIZE = 4096;
+
+static uint8_t image_byte(size_t i)
+{
+    return (i * 7 + (i >> 8)) & 0xff;
+}
+
+/*
+ * Build an ELF32 image with a single PT_LOAD segment of memsz bytes at paddr,
+ * the first filesz ones holding image_byte() values.
+ */
+static std::vector<uint8_t> make_elf32(uint32_t entry, uint32_t paddr,
+                                       uint32_t filesz, uint32_t memsz)
+{
+    Elf32_Ehdr hdr;
+    Elf32_Phdr ph;
+    std::vector<uint8_t> image(sizeof(hdr) + sizeof(ph) + filesz);
+
+    std::memset(&hdr, 0, sizeof(hdr));
+    std::memcpy(hdr.e_ident, ELFMAG, SELFMAG);
+    hdr.e_ident[EI_CLASS] = ELFCLASS32;
+    hdr.e_ident[EI_DATA] = ELFDATA2LSB;
+    hdr.e_ident[EI_VERSION] = EV_CURRENT;
+    hdr.e_type = ET_EXEC;
+    hdr.e_version = EV_CURRENT;
+    hdr.e_entry = entry;
+    hdr.e_phoff = sizeof(hdr);
+    hdr.e_ehsize = sizeof(hdr);
+    hdr.e_phentsize = sizeof(ph);
+    hdr.e_phnum = 1;
+
+    std::memset(&ph, 0, sizeof(ph));
+    ph.p_type = PT_LOAD;
+    ph.p_offset = sizeof(hdr) + sizeof(ph);
+    ph.p_vaddr = paddr;
+    ph.p_paddr = paddr;
+    ph.p_filesz = filesz;
+    ph.p_memsz = memsz;
+    ph.p_flags = PF_R | PF_W | PF_X;
+
+    std::memcpy(&image[0], &hdr, sizeof(hdr));
+    std::memcpy(&image[sizeof(hdr)], &ph, sizeof(ph));
+
+    for (uint32_t i = 0; i < filesz; i++) {
+        image[ph.p_offset + i] = image_byte(i);
+    }
+
+    return image;
+}
+
+class LoaderTestBench : public TestBench {
+protected:
+    MemorySlave<> m_ram;
+    DebugInitiator m_initiator;
+    ImageLoader m_loader;
+
+    ImageLoadResult load(const void *data, size_t len, uint64_t addr)
+    {
+        ImageLoadResult result;
+
+        m_loader.load_data(data, len, m_initiator, addr, result);
+        return result;
+    }
+
+public:
+    LoaderTestBench(sc_core::sc_module_name n, ConfigManager &c)
+        : TestBench(n, c)
+        , m_ram("ram", c, 0x4000)
+        , m_initiator("initiator", c)
+    {
+        m_initiator.p_bus.connect(m_ram.p_bus);
+    }
+};
+
+#ifdef RABBITS_CONFIG_ZLIB
+RABBITS_UNIT_TESTBENCH(gzip_binary, LoaderTestBench)
+{
+    ImageLoadResult r = load(GZIP_IMAGE, sizeof(GZIP_IMAGE), 0x1000);
+
+    RABBITS_TEST_ASSERT_EQ(r.result, ImageLoadResult::LOAD_SUCCESS);
+    RABBITS_TEST_ASSERT(r.has_load_size);
+    RABBITS_TEST_ASSERT_EQ(r.load_size, IMAGE_SIZE);
+
+    for (size_t i = 0; i < IMAGE_SIZE; i++) {
+        RABBITS_TEST_ASSERT_EQ(m_ram.get_data()[0x1000 + i], image_byte(i));
+    }
+}
+
+RABBITS_UNIT_TESTBENCH(gzip_truncated, LoaderTestBench)
+{
+    ImageLoadResult r = load(GZIP_IMAGE, sizeof(GZIP_IMAGE) / 2, 0x1000);
+
+    RABBITS_TEST_ASSERT_EQ(r.result, ImageLoadResult::LOAD_ERROR);
+
+    /* Nothing but the gzip header */
+    r = load(GZIP_IMAGE, 10, 0x1000);
+
+    RABBITS_TEST_ASSERT_EQ(r.result, ImageLoadResult::LOAD_ERROR);
+}
+
+RABBITS_UNIT_TESTBENCH(gzip_elf, LoaderTestBench)
+{
+    std::memset(m_ram.get_data() + 0x2000, 0xff, 0x300);
+
+    ImageLoadResult r = load(GZIP_ELF_IMAGE, sizeof(GZIP_ELF_IMAGE), 0);
+
+    RABBITS_TEST_ASSERT_EQ(r.result, ImageLoadResult::LOAD_SUCCESS);
+    RABBITS_TEST_ASSERT(r.has_entry_point);
+    RABBITS_TEST_ASSERT_EQ(r.entry_point, 0x2010u);
+
+    for (size_t i = 0; i < 0x100; i++) {
+        RABBITS_TEST_ASSERT_EQ(m_ram.get_data()[0x2000 + i], image_byte(i));
+        RABBITS_TEST_ASSERT_EQ(m_ram.get_data()[0x2100 + i], 0);
+        RABBITS_TEST_ASSERT_EQ(m_ram.get_data()[0x2200 + i], 0xff);
+    }
+}
+#endif
+
+#ifdef RABBITS_CONFIG_ZSTD
+RABBITS_UNIT_TESTBENCH(zstd_binary, LoaderTestBench)
+{
+    ImageLoadResult r = load(ZSTD_IMAGE, sizeof(ZSTD_IMAGE), 0x1000);
+
+    RABBITS_TEST_ASSERT_EQ(r.result, ImageLoadResult::LOAD_SUCCESS);
+    RABBITS_TEST_ASSERT(r.has_load_size);
+    RABBITS_TEST_ASSERT_EQ(r.load_size, IMAGE_SIZE);
+
+    for (size_t i = 0; i < IMAGE_SIZE; i++) {
+        RABBITS_TEST_ASSERT_EQ(m_ram.get_data()[0x1000 + i], image_byte(i));
+    }
+}
+
+RABBITS_UNIT_TESTBENCH(zstd_truncated, LoaderTestBench)
+{
+    ImageLoadResult r = load(ZSTD_IMAGE, sizeof(ZSTD_IMAGE) / 2, 0x1000);
+
+    RABBITS_TEST_ASSERT_EQ(r.result, ImageLoadResult::LOAD_ERROR);
+}
+#endif
+
+RABBITS_UNIT_TESTBENCH(elf_bss, LoaderTestBench)
+{
+    std::vector<uint8_t> elf = make_elf32(0x2010, 0x2000, 0x100, 0x200);
+
+    std::memset(m_ram.get_data() + 0x2000, 0xff, 0x300);
+
+    ImageLoadResult r = load(&elf[0], elf.size(), 0);
+
+    RABBITS_TEST_ASSERT_EQ(r.result, ImageLoadResult::LOAD_SUCCESS);
+    RABBITS_TEST_ASSERT(r.has_entry_point);
+    RABBITS_TEST_ASSERT_EQ(r.entry_point, 0x2010u);
+
+    for (size_t i = 0; i < 0x100; i++) {
+        RABBITS_TEST_ASSERT_EQ(m_ram.get_data()[0x2000 + i], image_byte(i));
+        RABBITS_TEST_ASSERT_EQ(m_ram.get_data()[0x2100 + i], 0);
+        RABBITS_TEST_ASSERT_EQ(m_ram.get_data()[0x2200 + i], 0xff);
+    }
+}
+
+RABBITS_UNIT_TESTBENCH(elf_truncated_segment, LoaderTestBench)
+{
+    std::vector<uint8_t> elf = make_elf32(0x2010, 0x2000, 0x100, 0x200);
+
+    ImageLoadResult r = load(&elf[0], elf.size() - 0x10, 0);
+
+    RABBITS_TEST_ASSERT_EQ(r.result, ImageLoadResult::LOAD_ERROR);
+}
+
+RABBITS_UNIT_TESTBENCH(elf_bss_past_ram, LoaderTestBench)
+{
+    /* The bss runs past the end of the RAM, the image is still loaded */
+    std::vector<uint8_t> elf = make_elf32(0x3f00, 0x3f00, 0x80, 0x200);
+
+    std::memset(m_ram.get_data() + 0x3f00, 0xff, 0x100);
+
+    ImageLoadResult r = load(&elf[0], elf.size(), 0);
+
+    RABBITS_TEST_ASSERT_EQ(r.result, ImageLoadResult::LOAD_SUCCESS);
+
+    for (size_t i = 0; i < 0x80; i++) {
+        RABBITS_TEST_ASSERT_EQ(m_ram.get_data()[0x3f00 + i], image_byte(i));
+        RABBITS_TEST_ASSERT_EQ(m_ram.get_data()[0x3f80 + i], 0);
+    }
+}
+
+RABBITS_UNIT_TESTBENCH(gzip_lookalike, LoaderTestBench)
+{
+    /* Not deflate compressed, this is a raw image */
+    const uint8_t raw[8] = { 0x1f, 0x8b, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06 };
+    ImageLoadResult r = load(raw, sizeof(raw), 0x100);
+
+    RABBITS_TEST_ASSERT_EQ(r.result, ImageLoadResult::LOAD_SUCCESS);
+    RABBITS_TEST_ASSERT_EQ(r.load_size, sizeof(raw));
+    RABBITS_TEST_ASSERT(std::memcmp(m_ram.get_data() + 0x100, raw, sizeof(raw)) == 0);
+}